@@ -0,0 +1,55 @@
+/**
+ * @file bench.h
+ * @brief Kernels of the contract overhead microbenchmarks, see contract_bench.c
+ * @version 0.1.4
+ * @license MIT
+ * @author Jeremy Thornton
+ */
+#ifndef CONTRACT_BENCH_H
+#define CONTRACT_BENCH_H
+
+/**
+ * @brief Elements per kernel call, small enough for the data segment of an 8086 build
+ */
+#define BENCH_N 256
+
+/**
+ * @brief Compiler identification written in the first column of every result
+ */
+#if defined(__WATCOMC__)
+#define BENCH_STR_(x) #x
+#define BENCH_STR(x) BENCH_STR_(x)
+#define BENCH_COMPILER "watcom " BENCH_STR(__WATCOMC__)
+#elif defined(__clang__)
+#define BENCH_COMPILER "clang " __clang_version__
+#elif defined(__GNUC__)
+#define BENCH_COMPILER "gcc " __VERSION__
+#elif defined(_MSC_VER)
+#define BENCH_STR_(x) #x
+#define BENCH_STR(x) BENCH_STR_(x)
+#define BENCH_COMPILER "msvc " BENCH_STR(_MSC_VER)
+#else
+#define BENCH_COMPILER "unknown"
+#endif
+
+/**
+ * @brief Sums v[0..n), checking each element with the contracts of one build setting
+ *
+ * Each kernel is the same loop, bench_loop.h, compiled in its own translation unit with a different
+ * CONTRACT_LEVEL or sampling configuration. bench_loop_raw() has no contracts at all.
+ *
+ * @param v Elements, all in 0..999 so every contract holds
+ * @param n Number of elements
+ * @return Sum of the elements
+ */
+typedef long (*bench_loop_t)(const int *v, int n);
+
+long bench_loop_raw(const int *v, int n);
+long bench_loop_none(const int *v, int n);          // CONTRACT_LEVEL_NONE
+long bench_loop_require(const int *v, int n);       // CONTRACT_LEVEL_REQUIRE
+long bench_loop_ensure(const int *v, int n);        // CONTRACT_LEVEL_ENSURE
+long bench_loop_invariant(const int *v, int n);     // CONTRACT_LEVEL_INVARIANT
+long bench_loop_audit(const int *v, int n);         // CONTRACT_LEVEL_AUDIT
+long bench_loop_sampled(const int *v, int n);       // CONTRACT_LEVEL_AUDIT, all levels sampled 1 in CONTRACT_SAMPLE_RATE
+
+#endif
@@ -0,0 +1,5 @@
+// Kernel built at CONTRACT_LEVEL_AUDIT
+#undef CONTRACT_LEVEL
+#define CONTRACT_LEVEL CONTRACT_LEVEL_AUDIT
+#define BENCH_LOOP bench_loop_audit
+#include "bench_loop.h"
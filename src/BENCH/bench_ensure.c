@@ -0,0 +1,5 @@
+// Kernel built at CONTRACT_LEVEL_ENSURE
+#undef CONTRACT_LEVEL
+#define CONTRACT_LEVEL CONTRACT_LEVEL_ENSURE
+#define BENCH_LOOP bench_loop_ensure
+#include "bench_loop.h"
@@ -0,0 +1,5 @@
+// Kernel built at CONTRACT_LEVEL_INVARIANT
+#undef CONTRACT_LEVEL
+#define CONTRACT_LEVEL CONTRACT_LEVEL_INVARIANT
+#define BENCH_LOOP bench_loop_invariant
+#include "bench_loop.h"
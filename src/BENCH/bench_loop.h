@@ -0,0 +1,24 @@
+/**
+ * @file bench_loop.h
+ * @brief The benchmark kernel, included once per build setting with BENCH_LOOP naming the function
+ * @version 0.1.4
+ * @license MIT
+ * @author Jeremy Thornton
+ */
+#include "../CONTRACT/contract.h"
+#include "bench.h"
+
+// One contract of each level per element, a level setting enables those up to its own
+long BENCH_LOOP(const int *v, int n) {
+    long sum = 0;
+    int i;
+
+    for (i = 0; i < n; i++) {
+        require(v[i] >= 0, "Negative element");
+        ensure(sum >= 0, "Sum wrapped");
+        invariant(i < n, "Index past the end");
+        audit(v[i] < 1000, "Element too large");
+        sum += v[i];
+    }
+    return sum;
+}
@@ -0,0 +1,5 @@
+// Kernel built at CONTRACT_LEVEL_NONE, every contract compiled out, should match bench_loop_raw()
+#undef CONTRACT_LEVEL
+#define CONTRACT_LEVEL CONTRACT_LEVEL_NONE
+#define BENCH_LOOP bench_loop_none
+#include "bench_loop.h"
@@ -0,0 +1,10 @@
+#include "bench.h"
+
+// The kernel loop without contracts, the baseline of the others
+long bench_loop_raw(const int *v, int n) {
+    long sum = 0;
+    int i;
+
+    for (i = 0; i < n; i++) sum += v[i];
+    return sum;
+}
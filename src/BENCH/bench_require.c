@@ -0,0 +1,5 @@
+// Kernel built at CONTRACT_LEVEL_REQUIRE
+#undef CONTRACT_LEVEL
+#define CONTRACT_LEVEL CONTRACT_LEVEL_REQUIRE
+#define BENCH_LOOP bench_loop_require
+#include "bench_loop.h"
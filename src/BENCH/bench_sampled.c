@@ -0,0 +1,7 @@
+// Kernel built at CONTRACT_LEVEL_AUDIT with every level sampled, see CONTRACT_SAMPLE_LEVEL
+#undef CONTRACT_LEVEL
+#define CONTRACT_LEVEL CONTRACT_LEVEL_AUDIT
+#undef CONTRACT_SAMPLE_LEVEL
+#define CONTRACT_SAMPLE_LEVEL CONTRACT_LEVEL_REQUIRE
+#define BENCH_LOOP bench_loop_sampled
+#include "bench_loop.h"
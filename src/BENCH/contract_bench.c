@@ -0,0 +1,207 @@
+/**
+ * @file contract_bench.c
+ * @brief Microbenchmarks of the contract macros and runtime: contract_bench [name prefix]
+ *
+ * Prints one CSV record per benchmark to stdout, lines starting with # are comments:
+ *     compiler,benchmark,ops,seconds,ns_per_op
+ * so runs of different releases and compilers can be concatenated and compared.
+ *
+ * Each benchmark doubles its repetitions until it runs for BENCH_SECONDS, long enough for the 55 ms
+ * clock() of DOS. The library must be built with CONTRACT_RECOVERABLE=1 for the failure paths.
+ *
+ * @version 0.1.4
+ * @license MIT
+ * @author Jeremy Thornton
+ */
+#include "bench.h"
+#include "../CONTRACT/contract.h"
+#include "../CONTRACT/contract_async.h"
+#include "../CONTRACT/contract_binlog.h"
+#include "../CONTRACT/contract_stats.h"
+#include <stdio.h>
+#include <string.h>
+#include <setjmp.h>
+
+#if !CONTRACT_RECOVERABLE
+#error "contract_bench needs CONTRACT_RECOVERABLE=1, the failure benchmarks return from the handler"
+#endif
+
+#define BENCH_SECONDS 0.5
+
+typedef struct {
+    const char *name;
+    bench_loop_t loop;          /**< Kernel called for BENCH_N elements per repetition, or NULL */
+    long (*run)(long reps);     /**< Otherwise runs reps repetitions and returns the operations done */
+} bench_t;
+
+static volatile long bench_sink;
+static volatile int bench_bad = -1;     // volatile, so the violation is not folded away
+static int bench_data[BENCH_N];
+static jmp_buf bench_env;
+
+// require_sampled() in the default build, checked on one pass in 16
+static long bench_loop_require_sampled(const int *v, int n) {
+    long sum = 0;
+    int i;
+
+    for (i = 0; i < n; i++) {
+        require_sampled(v[i] >= 0, "Negative element", 16);
+        sum += v[i];
+    }
+    return sum;
+}
+
+// One violation per call, through whichever handler is installed
+static posix_error_t bench_violate(int x) {
+    return try_require(x >= 0, "Bench violation");
+}
+
+static long bench_fail(long reps) {
+    long r;
+
+    for (r = 0; r < reps; r++) bench_sink += bench_violate(bench_bad);
+    return reps;
+}
+
+static void bench_discard(const contract_record_t *rec, void *ctx) {
+    (void)rec;
+    (void)ctx;
+}
+
+static long bench_fail_async(long reps) {
+    long r;
+
+    for (r = 0; r < reps; r++) {
+        bench_sink += bench_violate(bench_bad);
+        if ((r & 63) == 63) contract_async_drain(bench_discard, NULL);  // keep the queue from filling
+    }
+    contract_async_drain(bench_discard, NULL);
+    return reps;
+}
+
+static long bench_fail_longjmp(long reps) {
+    volatile long r;
+
+    contract_set_recovery(&bench_env);
+    for (r = 0; r < reps; r++) {
+        if (setjmp(bench_env) == 0) bench_sink += bench_violate(bench_bad);
+    }
+    contract_set_recovery(NULL);
+    return reps;
+}
+
+static long bench_fail_format(long reps) {
+    static const contract_site_t site = { "x >= 0", "Bench violation", "contract_bench.c", 1, POSIX_EINVAL, NULL };
+    char line[CONTRACT_LINE_MAX];
+    time_t stamp = time(NULL);
+    long r;
+
+    for (r = 0; r < reps; r++) bench_sink += contract_format(line, sizeof(line), &site, site.err, stamp);
+    return reps;
+}
+
+// Every code from 0 to 150, known or not
+static long bench_strerror(long reps) {
+    long r;
+    int e;
+
+    for (r = 0; r < reps; r++) {
+        for (e = 0; e <= 150; e++) bench_sink += contract_strerror((posix_error_t)e)[0];
+    }
+    return reps * 151;
+}
+
+static long bench_strerror_libc(long reps) {
+    long r;
+    int e;
+
+    for (r = 0; r < reps; r++) {
+        for (e = 0; e <= 150; e++) bench_sink += strerror(e)[0];
+    }
+    return reps * 151;
+}
+
+static long bench_run(const bench_t *b, long reps) {
+    long r;
+
+    if (!b->run) {
+        for (r = 0; r < reps; r++) bench_sink += b->loop(bench_data, BENCH_N);
+        return reps * BENCH_N;
+    }
+    return b->run(reps);
+}
+
+static void bench_measure(const bench_t *b) {
+    clock_t start, elapsed;
+    long reps = 1, ops;
+    double seconds;
+
+    for (;;) {
+        start = clock();
+        ops = bench_run(b, reps);
+        elapsed = clock() - start;
+        seconds = (double)elapsed / CLOCKS_PER_SEC;
+        if (seconds >= BENCH_SECONDS || ops > 0x3FFFFFFFL) break;     // doubling again could overflow a 32 bit long
+        reps *= 2;
+    }
+    printf("%s,%s,%ld,%.3f,%.2f\n", BENCH_COMPILER, b->name, ops, seconds, ops ? seconds * 1e9 / ops : 0.0);
+    fflush(stdout);
+}
+
+static int bench_selected(const bench_t *b, const char *prefix) {
+    return !prefix || strncmp(b->name, prefix, strlen(prefix)) == 0;
+}
+
+int main(int argc, char *argv[]) {
+    static const bench_t loops[] = {
+        { "loop/raw", bench_loop_raw, NULL },
+        { "loop/none", bench_loop_none, NULL },
+        { "loop/require", bench_loop_require, NULL },
+        { "loop/ensure", bench_loop_ensure, NULL },
+        { "loop/invariant", bench_loop_invariant, NULL },
+        { "loop/audit", bench_loop_audit, NULL },
+        { "loop/audit_sampled", bench_loop_sampled, NULL },
+        { "loop/require_sampled", bench_loop_require_sampled, NULL },
+        { "strerror/contract", NULL, bench_strerror },
+        { "strerror/libc", NULL, bench_strerror_libc },
+        { "fail/format", NULL, bench_fail_format }
+    };
+    // The failure path under each handler, contract_handler_abort() ends the process and is left out
+    static const struct {
+        bench_t bench;
+        contract_handler_t handler;
+        int limited;            /**< 1 suppresses every report, 0 lets every report through */
+    } fails[] = {
+        { { "fail/return", NULL, bench_fail }, contract_handler_return, 0 },
+        { { "fail/log_suppressed", NULL, bench_fail }, contract_handler_log, 1 },
+        { { "fail/longjmp_suppressed", NULL, bench_fail_longjmp }, contract_handler_longjmp, 1 },
+        { { "fail/async", NULL, bench_fail_async }, contract_handler_async, 0 },
+        { { "fail/binlog", NULL, bench_fail }, contract_handler_binlog, 0 }
+    };
+    const char *prefix = argc > 1 ? argv[1] : NULL;
+    FILE *binlog = tmpfile();
+    unsigned i;
+
+    for (i = 0; i < BENCH_N; i++) bench_data[i] = (int)(i * 7 % 1000);
+    if (binlog) contract_binlog_attach(binlog);
+
+    printf("# contract_bench, CONTRACT_LEVEL=%d CONTRACT_SAMPLE_RATE=%d CONTRACT_STATS=%d CONTRACT_PROFILE=%d\n",
+        CONTRACT_LEVEL, CONTRACT_SAMPLE_RATE, CONTRACT_STATS, CONTRACT_PROFILE);
+    printf("compiler,benchmark,ops,seconds,ns_per_op\n");
+
+    for (i = 0; i < sizeof(loops) / sizeof(loops[0]); i++) {
+        if (bench_selected(&loops[i], prefix)) bench_measure(&loops[i]);
+    }
+    for (i = 0; i < sizeof(fails) / sizeof(fails[0]); i++) {
+        if (!bench_selected(&fails[i].bench, prefix)) continue;
+        if (fails[i].limited) contract_set_rate_limit(0, (unsigned long)-1);
+        else contract_set_rate_limit(CONTRACT_REPORT_BURST, 0);
+        contract_set_handler(fails[i].handler);
+        bench_measure(&fails[i].bench);
+    }
+    contract_set_handler(NULL);
+    contract_set_rate_limit(CONTRACT_REPORT_BURST, CONTRACT_REPORT_PERIOD);
+    contract_binlog_close();
+    if (binlog) fclose(binlog);
+    return 0;
+}
@@ -1,34 +1,409 @@
-#include "contract.h" 
+#define _POSIX_C_SOURCE 200112L   // write, ssize_t, localtime_r
+
+#include "contract.h"
+#include "contract_async.h"
+#include "contract_stats.h"
 #include <time.h>
-#include <string.h>
 #include <stdlib.h>
+#include <stdio.h>
+
+#if defined(__WATCOMC__) && defined(__DOS__)
+#include <dos.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#define CONTRACT_HAVE_UNISTD 1
+#elif defined(_WIN32)
+#include <io.h>
+#endif
+
+#ifndef CONTRACT_HAVE_UNISTD
+#define CONTRACT_HAVE_UNISTD 0
+#endif
+
+static contract_handler_t contract_handler = contract_handler_abort;
+static CONTRACT_THREAD_LOCAL jmp_buf *contract_recovery = NULL;
+CONTRACT_THREAD_LOCAL unsigned long _contract_sample_state = 0;
+CONTRACT_THREAD_LOCAL unsigned long _contract_scope_serial = 0;
+static CONTRACT_THREAD_LOCAL long contract_index_pending = -1;
+static CONTRACT_THREAD_LOCAL long contract_index = -1;
+
+void _contract_set_index(long index) {
+    contract_index_pending = index;
+}
 
-void _contract_fail(
-    const char *cond,
-    const char *msg,
-    const char *file,
-    int line
-) {
-    time_t now = time(NULL);
-    struct tm *tm_info;
-    char datetime[20]; // YYYY-MM-DD HH:MM:SS\0
-    const char *filename = file;
-
-    // Extract just the filename portion
-    const char *last_slash = strrchr(file, '\\');
-    if (!last_slash) last_slash = strrchr(file, '/');
-    if (last_slash) filename = last_slash + 1;
-
-    tm_info = localtime(&now);
-    strftime(datetime, sizeof(datetime), "%Y-%m-%d %H:%M:%S", tm_info);
-
-    fprintf(stderr, "[%s] %s:%d|%s|%d(%s)|%s\n",
-            datetime,
-            filename,
-            line,
-            cond,
-            errno,
-            contract_strerror(errno),
-            msg);
+long contract_failed_index(void) {
+    return contract_index;
+}
+
+posix_error_t _contract_fail(const contract_site_t *site) {
+    posix_error_t err;
+
+    contract_index = contract_index_pending;    // the predicate that just failed may have named an element
+    contract_index_pending = -1;
+    errno = site->err;
+    contract_stats_hit(site);
+    err = contract_handler(site);
+#if CONTRACT_RECOVERABLE
+    errno = err;
+    return err;
+#else
+    (void)err;
+    contract_flush();
     abort();
+#endif
+}
+
+posix_error_t _contract_fail_at(const char *cond, const char *msg, const char *file, int line, posix_error_t err) {
+    contract_site_t site;
+
+    site.cond = cond;
+    site.msg = msg;
+    site.file = file;
+    site.line = line;
+    site.err = err;
+    site.stats = NULL;
+#if CONTRACT_RECOVERABLE
+    return _contract_fail(&site);
+#else
+    _contract_fail(&site);
+#endif
+}
+
+contract_handler_t contract_set_handler(contract_handler_t handler) {
+    contract_handler_t previous = contract_handler;
+
+    contract_handler = handler ? handler : contract_handler_abort;
+    return previous;
+}
+
+void contract_set_recovery(jmp_buf *env) {
+    contract_recovery = env;
+}
+
+// Bounded output cursor of the hand-rolled formatter, end leaves room for the newline and NUL
+typedef struct {
+    char *p;
+    char *end;
+} contract_out_t;
+
+static void contract_put(contract_out_t *out, const char *s) {
+    while (*s && out->p < out->end) *out->p++ = *s++;
+}
+
+static void contract_put_char(contract_out_t *out, char c) {
+    if (out->p < out->end) *out->p++ = c;
+}
+
+static void contract_put_digits(contract_out_t *out, unsigned long v, unsigned base, int width) {
+    char digits[12];
+    int n = 0;
+
+    do {
+        digits[n++] = "0123456789ABCDEF"[v % base];
+        v /= base;
+    } while (v || n < width);
+    while (n) contract_put_char(out, digits[--n]);
+}
+
+static void contract_put_int(contract_out_t *out, long v) {
+    if (v < 0) {
+        contract_put_char(out, '-');
+        contract_put_digits(out, 0UL - (unsigned long)v, 10, 1);
+    } else {
+        contract_put_digits(out, (unsigned long)v, 10, 1);
+    }
+}
+
+// Days since 1970-01-01 to the civil date, after H. Hinnant's days_from_civil inverse
+static void contract_civil(long days, unsigned long *y, unsigned *m, unsigned *d) {
+    long era;
+    unsigned long doe, yoe, doy, mp;
+
+    days += 719468L;
+    era = (days >= 0 ? days : days - 146096L) / 146097L;
+    doe = (unsigned long)(days - era * 146097L);
+    yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    mp = (5 * doy + 2) / 153;
+    *d = (unsigned)(doy - (153 * mp + 2) / 5 + 1);
+    *m = (unsigned)(mp < 10 ? mp + 3 : mp - 9);
+    *y = (unsigned long)(yoe + era * 400 + (*m <= 2));
+}
+
+static long contract_days(unsigned long y, unsigned m, unsigned d) {
+    unsigned long era, yoe, doy, doe;
+
+    y -= m <= 2;
+    era = y / 400;
+    yoe = y - era * 400;
+    doy = (153UL * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return (long)(era * 146097UL + doe) - 719468L;
+}
+
+/**
+ * @brief Per thread cache of the local UTC offset
+ *
+ * Valid for one quarter hour of log time, the granularity of daylight saving transitions, so
+ * localtime(), neither reentrant nor async-signal-safe, runs at most once per thread per quarter
+ * hour of reports rather than once per report.
+ */
+typedef struct {
+    long offset;    /**< Seconds east of UTC */
+    long from;      /**< Start of the quarter hour the offset was sampled for */
+    int valid;      /**< Non-zero once sampled */
+} contract_clock_t;
+
+static CONTRACT_THREAD_LOCAL contract_clock_t contract_clock;
+
+static void contract_clock_sync(time_t stamp) {
+#if CONTRACT_HAVE_UNISTD
+    struct tm tm;
+    struct tm *lt = localtime_r(&stamp, &tm);
+#else
+    struct tm *lt = localtime(&stamp);
+#endif
+    long local;
+
+    contract_clock.from = (long)stamp - (long)stamp % 900L;
+    contract_clock.valid = 1;
+    if (!lt) {
+        contract_clock.offset = 0;
+        return;
+    }
+    local = contract_days((unsigned long)lt->tm_year + 1900, (unsigned)lt->tm_mon + 1, (unsigned)lt->tm_mday) * 86400L
+        + lt->tm_hour * 3600L + lt->tm_min * 60L + lt->tm_sec;
+    contract_clock.offset = local - (long)stamp;
+}
+
+static contract_timestamp_t contract_timestamp = CONTRACT_TIMESTAMP_LOCAL;
+
+// Per thread copy of the last local timestamp formatted, "[YYYY-MM-DD HH:MM:SS]"
+static CONTRACT_THREAD_LOCAL struct {
+    time_t stamp;
+    int len;
+    char text[24];
+} contract_stamp;
+
+contract_timestamp_t contract_set_timestamp(contract_timestamp_t mode) {
+    contract_timestamp_t previous = contract_timestamp;
+    contract_timestamp = mode;
+    return previous;
+}
+
+static void contract_format_time(contract_out_t *out, time_t stamp) {
+    unsigned long y;
+    unsigned m, d;
+    long t, secs;
+
+    if (!contract_clock.valid || (long)stamp < contract_clock.from || (long)stamp >= contract_clock.from + 900L) {
+        contract_clock_sync(stamp);
+    }
+    t = (long)stamp + contract_clock.offset;
+    secs = t % 86400L;
+    if (secs < 0) secs += 86400L;
+    contract_civil((t - secs) / 86400L, &y, &m, &d);
+
+    contract_put_char(out, '[');
+    contract_put_digits(out, y, 10, 4);
+    contract_put_char(out, '-');
+    contract_put_digits(out, m, 10, 2);
+    contract_put_char(out, '-');
+    contract_put_digits(out, d, 10, 2);
+    contract_put_char(out, ' ');
+    contract_put_digits(out, (unsigned long)secs / 3600, 10, 2);
+    contract_put_char(out, ':');
+    contract_put_digits(out, (unsigned long)secs / 60 % 60, 10, 2);
+    contract_put_char(out, ':');
+    contract_put_digits(out, (unsigned long)secs % 60, 10, 2);
+    contract_put_char(out, ']');
+}
+
+static void contract_put_time(contract_out_t *out, time_t stamp) {
+    contract_out_t text;
+
+    if (contract_timestamp == CONTRACT_TIMESTAMP_RAW) {
+        contract_put(out, "[@");
+        contract_put_int(out, (long)stamp);
+        contract_put_char(out, ']');
+        return;
+    }
+    if (!contract_stamp.len || contract_stamp.stamp != stamp) {
+        text.p = contract_stamp.text;
+        text.end = contract_stamp.text + sizeof(contract_stamp.text) - 1;
+        contract_format_time(&text, stamp);
+        *text.p = '\0';
+        contract_stamp.len = (int)(text.p - contract_stamp.text);
+        contract_stamp.stamp = stamp;
+    }
+    contract_put(out, contract_stamp.text);
+}
+
+// Terminates the line at the cursor, always with its newline
+static int contract_put_end(contract_out_t *out, char *buf) {
+    *out->p++ = '\n';
+    *out->p = '\0';
+    return (int)(out->p - buf);
+}
+
+int contract_format(char *buf, size_t size, const contract_site_t *site, posix_error_t err, time_t stamp) {
+    contract_out_t out;
+
+    if (size < 2) {
+        if (size) *buf = '\0';
+        return 0;
+    }
+    out.p = buf;
+    out.end = buf + size - 2;
+
+    contract_put_time(&out, stamp);
+    contract_put_char(&out, ' ');
+    contract_put(&out, site->file);
+    contract_put_char(&out, ':');
+    contract_put_int(&out, site->line);
+    contract_put_char(&out, '|');
+    if (site->cond) {
+        contract_put(&out, site->cond);
+    } else {        // CONTRACT_STRIP_TEXT, print the site id for contract_decode
+        contract_put_char(&out, '#');
+        contract_put_digits(&out, contract_site_id(site), 16, 8);
+    }
+    contract_put_char(&out, '|');
+    contract_put_int(&out, (long)err);
+    contract_put_char(&out, '(');
+    contract_put(&out, contract_strerror(err));
+    contract_put(&out, ")|");
+    if (site->msg) contract_put(&out, site->msg);
+    return contract_put_end(&out, buf);
+}
+
+void contract_write(const char *buf, size_t len) {
+    int saved = errno;      // the handler's caller still expects the contract's errno
+#if defined(__WATCOMC__) && defined(__DOS__)
+    unsigned written;
+
+    // INT 21h function 40h, write to handle 2
+    while (len && _dos_write(2, buf, (unsigned)len, &written) == 0 && written) {
+        buf += written;
+        len -= written;
+    }
+#elif CONTRACT_HAVE_UNISTD
+    ssize_t written;
+
+    while (len) {
+        written = write(2, buf, len);
+        if (written < 0 && errno == EINTR) continue;
+        if (written <= 0) break;
+        buf += written;
+        len -= (size_t)written;
+    }
+#elif defined(_WIN32)
+    _write(2, buf, (unsigned)len);
+#else
+    fwrite(buf, 1, len, stderr);
+    fflush(stderr);
+#endif
+    errno = saved;
+}
+
+// Per thread line buffer of the failure path, a report needs no stack beyond its frame nor any heap
+static CONTRACT_THREAD_LOCAL char contract_line[CONTRACT_LINE_MAX];
+
+// Reports with the optional " (index N)" and " (N suppressed)" suffixes, which contract_format() leaves room for
+static void contract_report_line(const contract_site_t *site, unsigned long suppressed) {
+    contract_out_t out;
+    int len;
+
+    len = contract_format(contract_line, sizeof(contract_line) - 48, site, site->err, time(NULL));
+    if (contract_index >= 0 || suppressed) {
+        out.p = contract_line + len - 1;    // over the newline
+        out.end = contract_line + sizeof(contract_line) - 2;
+        if (contract_index >= 0) {
+            contract_put(&out, " (index ");
+            contract_put_digits(&out, (unsigned long)contract_index, 10, 1);
+            contract_put_char(&out, ')');
+        }
+        if (suppressed) {
+            contract_put(&out, " (");
+            contract_put_digits(&out, suppressed, 10, 1);
+            contract_put(&out, " suppressed)");
+        }
+        len = contract_put_end(&out, contract_line);
+    }
+    contract_write(contract_line, (size_t)len);
+}
+
+void contract_report(const contract_site_t *site) {
+    contract_report_line(site, 0);
+}
+
+// contract_report() subject to the contract_should_report() rate limit, a summary notes the suppressed count
+static void contract_report_limited(const contract_site_t *site) {
+    unsigned long suppressed;
+
+    if (contract_should_report(site, &suppressed)) contract_report_line(site, suppressed);
+}
+
+posix_error_t contract_handler_abort(const contract_site_t *site) {
+    contract_flush();   // earlier asynchronous reports first
+    contract_report(site);
+    abort();
+    return site->err;
+}
+
+posix_error_t contract_handler_log(const contract_site_t *site) {
+    contract_report_limited(site);
+    return site->err;
+}
+
+posix_error_t contract_handler_longjmp(const contract_site_t *site) {
+    jmp_buf *env = contract_recovery;
+
+    contract_report_limited(site);
+    if (!env) abort();
+    errno = site->err;
+    longjmp(*env, site->err != POSIX_SUCCESS ? (int)site->err : 1);
+    return site->err;
+}
+
+posix_error_t contract_handler_return(const contract_site_t *site) {
+    return site->err;
+}
+
+unsigned long _contract_sample_seed(void) {
+    unsigned long x = (unsigned long)time(NULL) ^ (unsigned long)(size_t)&_contract_sample_state;
+
+    x = (x * 2654435761UL) & 0xFFFFFFFFUL;     // spread the address bits, threads get different streams
+    _contract_sample_state = x ? x : 0x9E3779B9UL;
+    return _contract_sample_state;
+}
+
+unsigned long contract_site_id(const contract_site_t *site) {
+    unsigned long hash = 2166136261UL;  // FNV-1a 32 bit offset basis
+    const char *p;
+
+    for (p = site->file; *p; p++) {
+        hash ^= (unsigned char)*p;
+        hash = (hash * 16777619UL) & 0xFFFFFFFFUL;
+    }
+    hash = (hash >> 16) ^ (hash & 0xFFFF);  // fold to 16 bits
+    return (hash << 16) | ((unsigned long)site->line & 0xFFFF);
+}
+
+#if CONTRACT_HAVE_SITE_TABLE
+// Provided by the linker for the "contract_sites" section, weak so a binary without any contract still links
+extern const contract_site_t __start_contract_sites[] __attribute__((weak));
+extern const contract_site_t __stop_contract_sites[] __attribute__((weak));
+#endif
+
+void contract_site_foreach(void (*fn)(const contract_site_t *site, void *ctx), void *ctx) {
+#if CONTRACT_HAVE_SITE_TABLE
+    const contract_site_t *site;
+    for (site = __start_contract_sites; site < __stop_contract_sites; site++) {
+        fn(site, ctx);
+    }
+#else
+    (void)fn;
+    (void)ctx;
+#endif
 }
@@ -8,114 +8,825 @@
 #ifndef CONTRACT_H
 #define CONTRACT_H
 
+#include "contract_config.h"
 #include "contract_errors.h"
+#include "contract_ticks.h"
 #include <errno.h>
+#include <limits.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <time.h>
 
 /**
- * @brief Handles contract violation by printing detailed error information and terminating the program
+ * @brief Mutable violation counters of one contract site, see contract_stats.h
  *
- * This function is called when a contract condition fails. It prints a formatted error message
- * including timestamp, file location, failed condition, errno value, and descriptive message,
- * then terminates the program with abort().
+ * A site's block is linked into the statistics list the first time the site fails.
+ */
+typedef struct contract_stats_s {
+    const struct contract_site_s *site;     /**< The site counted, set on first violation */
+    struct contract_stats_s *next;          /**< Next site in the statistics list */
+    unsigned long hits;                     /**< Total violations of the site */
+    unsigned long reported;                 /**< Violations let through by the rate limit */
+    unsigned long suppressed;               /**< Violations suppressed since the last report */
+    unsigned long last_report;              /**< time() of the last report, as unsigned long */
+} contract_stats_t;
+
+/**
+ * @brief Evaluation counters of one contract site in a CONTRACT_PROFILE build, see contract_profile.h
+ *
+ * A site's block is linked into the profile list the first time the site is evaluated.
+ */
+typedef struct contract_profile_s {
+    const struct contract_site_s *site;     /**< The site profiled, set on first evaluation */
+    struct contract_profile_s *next;        /**< Next site in the profile list */
+    contract_ticks_t evals;                 /**< Times the condition was evaluated */
+    contract_ticks_t ticks;                 /**< contract_ticks() spent evaluating it, 0 without CONTRACT_PROFILE_CYCLES */
+} contract_profile_t;
+
+/**
+ * @brief Static description of one contract site
+ *
+ * Every contract expansion emits exactly one of these as static const data, so reporting a violation
+ * passes a single pointer rather than the condition, message, file and line (four far pointers and
+ * an int on the 8086 large model) plus a separate errno store at each call site.
+ */
+typedef struct contract_site_s {
+    const char *cond;       /**< The contract condition, stringified, NULL with CONTRACT_STRIP_TEXT */
+    const char *msg;        /**< Custom error message describing the contract violation, NULL with CONTRACT_STRIP_TEXT */
+    const char *file;       /**< Source file name of the contract, without its directory */
+    int line;               /**< Source line of the contract */
+    posix_error_t err;      /**< POSIX error code set in errno on violation */
+    contract_stats_t *stats;    /**< Violation counters, NULL without CONTRACT_STATS */
+} contract_site_t;
+
+/**
+ * @brief Contract violation handler, installed with contract_set_handler()
+ *
+ * Called by _contract_fail() with errno already set to site->err. A handler may report the violation,
+ * terminate, longjmp, or return a posix_error_t which, in a CONTRACT_RECOVERABLE build, becomes the value
+ * of the failed try_* contract and execution resumes after the contract.
+ *
+ * @param site Descriptor of the contract that failed, static except when reported through _contract_fail_at(),
+ *             copy it rather than keep the pointer past the call
+ * @return The error to hand back to the failing site, normally site->err
+ */
+typedef posix_error_t (*contract_handler_t)(const contract_site_t *site);
+
+/**
+ * @brief Handles contract violation by setting errno and dispatching to the installed handler
+ *
+ * This function is called when a contract condition fails. It sets errno to the site's error code
+ * and calls the handler installed with contract_set_handler(), contract_handler_abort() by default.
+ * Unless CONTRACT_RECOVERABLE is 1 the program is terminated with abort() should the handler return.
+ *
+ * @param site Static descriptor of the contract that failed
+ * @return The handler's posix_error_t, CONTRACT_RECOVERABLE builds only
+ */
+#if CONTRACT_RECOVERABLE
+CONTRACT_COLD posix_error_t _contract_fail(const contract_site_t *site);
+#else
+CONTRACT_NORETURN CONTRACT_COLD posix_error_t _contract_fail(const contract_site_t *site);
+
+#ifdef __WATCOMC__
+#pragma aux _contract_fail aborts   // Watcom's noreturn, no epilogue or register reload after the call
+#endif
+#endif
+
+/**
+ * @brief As _contract_fail() for compilers where a try_* expression cannot hold a static site descriptor
+ *
+ * Builds the descriptor on the stack of the failure path, such sites are absent from the site table.
+ */
+#if CONTRACT_RECOVERABLE
+CONTRACT_COLD posix_error_t _contract_fail_at(const char *cond, const char *msg, const char *file, int line, posix_error_t err);
+#else
+CONTRACT_NORETURN CONTRACT_COLD posix_error_t _contract_fail_at(const char *cond, const char *msg, const char *file, int line, posix_error_t err);
+
+#ifdef __WATCOMC__
+#pragma aux _contract_fail_at aborts
+#endif
+#endif
+
+/**
+ * @brief Names the offending element of the contract about to fail, used by the array predicates
+ *
+ * @param index Element index, handed to the next _contract_fail() on this thread
+ */
+void _contract_set_index(long index);
+
+/**
+ * @brief Index of the offending element of the current thread's last violation
+ *
+ * Valid inside a handler and after a recovered try_* contract. contract_report() appends it as " (index N)".
+ *
+ * @return The element index, -1 if the contract that failed does not name one
+ */
+long contract_failed_index(void);
+
+/**
+ * @brief Installs the handler called on every contract violation
+ *
+ * The handler is process wide, install it once at start up. Passing NULL restores contract_handler_abort().
+ *
+ * @param handler The new violation handler, one of the contract_handler_* policies or a custom one
+ * @return The previously installed handler
+ */
+contract_handler_t contract_set_handler(contract_handler_t handler);
+
+/**
+ * @brief Timestamp written at the start of each text report, see contract_set_timestamp()
+ */
+typedef enum {
+    CONTRACT_TIMESTAMP_LOCAL = 0,   /**< [YYYY-MM-DD HH:MM:SS] local time, reformatted only when the second changes */
+    CONTRACT_TIMESTAMP_RAW = 1      /**< [@seconds since the epoch], converted offline by contract_decode */
+} contract_timestamp_t;
+
+/**
+ * @brief Selects the timestamp of the text reports
+ *
+ * Each thread keeps its last formatted local time, so a burst of violations within one second costs a
+ * 21 byte copy per report. CONTRACT_TIMESTAMP_RAW does away with the calendar and time zone altogether,
+ * for failure storms in log-and-continue mode, contract_decode restores the local time:
+ *     [@1722366733] main.c:42|p != NULL|14(Bad address)|NULL buffer!
+ * Process wide like the handler, select it once at start up.
+ *
+ * @param mode CONTRACT_TIMESTAMP_LOCAL, the default, or CONTRACT_TIMESTAMP_RAW
+ * @return The previous mode
+ */
+contract_timestamp_t contract_set_timestamp(contract_timestamp_t mode);
+
+/**
+ * @brief Sets the calling thread's recovery point for contract_handler_longjmp()
  *
- * @param cond The failed condition expression as a string
- * @param msg Custom error message describing the contract violation
- * @param file Source file name where the contract violation occurred
- * @param line Line number where the contract violation occurred
+ * @param env Buffer filled by setjmp(), or NULL to clear the recovery point
  *
- * @note This function sets errno to the appropriate POSIX error code before terminating
- * @note The error output format is: [YYYY-MM-DD HH:MM:SS] filename:line|condition|errno(errno_name)|message
+ * @example
+ *     jmp_buf env;
+ *     contract_set_recovery(&env);
+ *     if (setjmp(env) != 0) {
+ *         // errno holds the violated contract's posix_error_t
+ *     }
  */
-void _contract_fail(const char *cond, const char *msg, const char *file, int line);
+void contract_set_recovery(jmp_buf *env);
+
+/**
+ * @brief Writes the standard report line for a violated contract to stderr
+ *
+ * Format: [YYYY-MM-DD HH:MM:SS] filename:line|condition|errno(errno_name)|message
+ *
+ * The line is formatted into a per thread static buffer and written with a single contract_write(),
+ * so reporting neither allocates nor takes the stdio lock, and is safe when require_mem() fires on
+ * ENOMEM or from a signal handler (other than one interrupting a report on the same thread).
+ *
+ * @param site Static descriptor of the contract that failed
+ */
+void contract_report(const contract_site_t *site);
+
+/**
+ * @brief Writes buf to standard error without stdio, retrying short writes, errno is preserved
+ *
+ * - POSIX: write(2, ...)
+ * - Watcom DOS: _dos_write(), INT 21h function 40h on handle 2
+ * - Windows: _write(2, ...)
+ * - elsewhere: fwrite() and fflush() on stderr
+ *
+ * @param buf Bytes to write
+ * @param len Number of bytes
+ */
+void contract_write(const char *buf, size_t len);
+
+/**
+ * @brief Formats the standard report line, with its trailing newline, into buf
+ *
+ * Integers, the site id and the local time are formatted by hand, without printf, strftime or locale
+ * state. localtime() is only consulted to sample the UTC offset, which each thread caches for a quarter hour.
+ * The timestamp follows contract_set_timestamp().
+ *
+ * A site without text (CONTRACT_STRIP_TEXT) is written with its site id as the condition and an empty message:
+ *     [YYYY-MM-DD HH:MM:SS] filename:line|#1A2B002A|errno(errno_name)|
+ *
+ * @param buf Destination buffer, always NUL terminated
+ * @param size Size of buf in bytes
+ * @param site Static descriptor of the contract that failed
+ * @param err The errno recorded for the violation
+ * @param stamp Time of the violation
+ * @return Length of the formatted line, truncated to size - 1 but always ending in a newline
+ */
+int contract_format(char *buf, size_t size, const contract_site_t *site, posix_error_t err, time_t stamp);
+
+// Built-in violation handler policies
+posix_error_t contract_handler_abort(const contract_site_t *site);     // report then abort(), the default
+posix_error_t contract_handler_log(const contract_site_t *site);       // rate limited report then continue (log-and-continue)
+posix_error_t contract_handler_longjmp(const contract_site_t *site);   // rate limited report then longjmp to contract_set_recovery(), abort() if none
+posix_error_t contract_handler_return(const contract_site_t *site);    // return site->err silently (return-error-code)
+
+/**
+ * @brief Calls fn once for every contract site compiled into the binary
+ *
+ * Walks the "contract_sites" section, see CONTRACT_HAVE_SITE_TABLE. Sites of contracts compiled out by
+ * CONTRACT_LEVEL or a group switch are not present. Without a site table this function calls nothing.
+ *
+ * @param fn Callback invoked with each site descriptor
+ * @param ctx Caller context handed through to fn
+ */
+void contract_site_foreach(void (*fn)(const contract_site_t *site, void *ctx), void *ctx);
+
+/**
+ * @brief Stable numeric identifier of a contract site
+ *
+ * The identifier is a 16 bit FNV-1a hash of the site's file name in the high half and the line number
+ * in the low half, so it is the same for every build of the same source, whatever the target or level.
+ *
+ * @param site Static descriptor of the contract
+ * @return The 32 bit site id
+ */
+unsigned long contract_site_id(const contract_site_t *site);
+
+/**
+ * @brief Counts one evaluation of a contract in a CONTRACT_PROFILE build, links prof in on the first
+ *
+ * @param prof Profile block of the site
+ * @param site Static descriptor of the contract evaluated
+ * @param ticks contract_ticks() spent evaluating the condition
+ */
+void _contract_profile_add(contract_profile_t *prof, const contract_site_t *site, contract_ticks_t ticks);
+
+/**
+ * @brief Condition or message text of a contract site, NULL in a CONTRACT_STRIP_TEXT build
+ */
+#if CONTRACT_STRIP_TEXT
+#define _CONTRACT_TEXT(text) NULL
+#else
+#define _CONTRACT_TEXT(text) text
+#endif
+
+/**
+ * @brief Declares the static descriptor, and with CONTRACT_STATS the counter block, of one contract site
+ */
+#if CONTRACT_STATS
+#define _CONTRACT_SITE(cond, msg, err) \
+    static contract_stats_t _contract_stats; \
+    CONTRACT_SITE static const contract_site_t _contract_site = { _CONTRACT_TEXT(#cond), _CONTRACT_TEXT(msg), CONTRACT_FILE, __LINE__, err, &_contract_stats }
+#else
+#define _CONTRACT_SITE(cond, msg, err) \
+    CONTRACT_SITE static const contract_site_t _contract_site = { _CONTRACT_TEXT(#cond), _CONTRACT_TEXT(msg), CONTRACT_FILE, __LINE__, err, NULL }
+#endif
 
 /**
  * @brief Core contract enforcement macro that evaluates a condition and handles violations
  *
- * This macro tests a boolean condition and if it evaluates to false, it sets the specified
- * errno value and calls _contract_fail() to report the violation and terminate the program.
+ * This macro tests a boolean condition and if it evaluates to false, it calls _contract_fail()
+ * with the static site descriptor to set errno and hand the violation to the installed handler.
  * The condition expression is stringified for inclusion in the error report.
  *
+ * The condition is hinted as likely to hold and _contract_fail() is declared cold (and noreturn unless
+ * CONTRACT_RECOVERABLE), so a passing contract costs one predicted not-taken branch and the failure code
+ * is moved out of line.
+ *
+ * A CONTRACT_PROFILE build declares the site descriptor up front and counts (and with CONTRACT_PROFILE_CYCLES
+ * times) every evaluation of the condition through _contract_profile_add(), the try_* forms are not profiled.
+ *
  * @param cond Boolean condition to evaluate - contract passes if true
- * @param msg Custom error message to display if contract is violated
+ * @param msg Custom error message to display if contract is violated, must be a string literal
  * @param err POSIX error code to set in errno when contract is violated
  */
+#if CONTRACT_PROFILE
+#if CONTRACT_PROFILE_CYCLES
+#define _CONTRACT_EVAL(cond, ok) \
+    contract_ticks_t _contract_t0 = contract_ticks(); \
+    ok = !!(cond); \
+    _contract_profile_add(&_contract_profile, &_contract_site, contract_ticks() - _contract_t0)
+#else
+#define _CONTRACT_EVAL(cond, ok) \
+    ok = !!(cond); \
+    _contract_profile_add(&_contract_profile, &_contract_site, 0)
+#endif
 #define _CONTRACT_ENFORCE(cond, msg, err) \
     do { \
-        if (!(cond)) { \
-            errno = (err); \
-            _contract_fail(#cond, msg, __FILE__, __LINE__); \
+        _CONTRACT_SITE(cond, msg, err); \
+        static contract_profile_t _contract_profile; \
+        int _contract_ok; \
+        _CONTRACT_EVAL(cond, _contract_ok); \
+        if (CONTRACT_UNLIKELY(!_contract_ok)) _contract_fail(&_contract_site); \
+    } while (0)
+#else
+#define _CONTRACT_ENFORCE(cond, msg, err) \
+    do { \
+        if (CONTRACT_UNLIKELY(!(cond))) { \
+            _CONTRACT_SITE(cond, msg, err); \
+            _contract_fail(&_contract_site); \
         } \
     } while (0)
+#endif
+
+/**
+ * @brief Expression form of _CONTRACT_ENFORCE used by the try_* contracts
+ *
+ * Evaluates to POSIX_SUCCESS when the condition holds, otherwise to the value returned by the violation
+ * handler, so a CONTRACT_RECOVERABLE caller can fail fast: if (try_require_fd(fd >= 0, "Bad fd")) return errno;
+ * GCC and Clang keep the static site descriptor through a statement expression, other compilers pass
+ * the site fields to _contract_fail_at() on the failure path only.
+ *
+ * @param cond Boolean condition to evaluate - contract passes if true
+ * @param msg Custom error message to display if contract is violated, must be a string literal
+ * @param err POSIX error code returned and set in errno when contract is violated
+ */
+#if defined(__GNUC__) || defined(__clang__)
+#define _CONTRACT_CHECK(cond, msg, err) \
+    (CONTRACT_LIKELY(cond) ? POSIX_SUCCESS : __extension__ ({ \
+        _CONTRACT_SITE(cond, msg, err); \
+        _contract_fail(&_contract_site); \
+    }))
+#else
+#define _CONTRACT_CHECK(cond, msg, err) \
+    (CONTRACT_LIKELY(cond) ? POSIX_SUCCESS : _contract_fail_at(_CONTRACT_TEXT(#cond), _CONTRACT_TEXT(msg), CONTRACT_FILE, __LINE__, err))
+#endif
+
+/**
+ * @brief Expansion of a contract that has been compiled out by CONTRACT_LEVEL or a group switch
+ *
+ * The condition is placed inside sizeof so it is still type checked, and its variables count as used,
+ * but it is never evaluated and emits no code or branch.
+ *
+ * @warning Side effects in a disabled condition do not happen, e.g. require_mem(ptr = malloc(size), ...)
+ *          no longer allocates. Keep conditions free of side effects, exactly as with assert().
+ */
+#define _CONTRACT_DISABLED(cond, msg, err) \
+    do { \
+        (void)sizeof(!(cond)); \
+    } while (0)
+
+/**
+ * @brief Expression form of _CONTRACT_DISABLED, never evaluates the condition and is always POSIX_SUCCESS
+ */
+#define _CONTRACT_UNCHECKED(cond, msg, err) ((void)sizeof(!(cond)), POSIX_SUCCESS)
+
+/**
+ * @brief Per thread xorshift state of the CONTRACT_SAMPLE_RANDOM sampler, 0 until first used
+ */
+extern CONTRACT_THREAD_LOCAL unsigned long _contract_sample_state;
+
+/**
+ * @brief Seeds the calling thread's sampler from the time and the address of its state
+ *
+ * @return The new non-zero state
+ */
+unsigned long _contract_sample_seed(void);
+
+/**
+ * @brief Random 1 in rate decision of the CONTRACT_SAMPLE_RANDOM sampler
+ *
+ * @param rate Sampling rate, 0 and 1 sample every pass
+ * @return Non-zero to evaluate the contract on this pass
+ */
+CONTRACT_INLINE int _contract_sample(unsigned long rate) {
+    unsigned long x = _contract_sample_state;
+
+    if (CONTRACT_UNLIKELY(!x)) x = _contract_sample_seed();
+    x ^= (x << 13) & 0xFFFFFFFFUL;      // xorshift32, masked for 64 bit longs
+    x ^= x >> 17;
+    x ^= (x << 5) & 0xFFFFFFFFUL;
+    _contract_sample_state = x;
+    return rate <= 1 || x % rate == 0;
+}
+
+/**
+ * @brief Sampled form of _CONTRACT_ENFORCE, evaluates the condition on about one pass in rate
+ *
+ * The countdown sampler keeps one static per thread pass counter at each site, so a site is checked on
+ * its first pass and every rate-th pass after that, whatever other sites do in between.
+ *
+ * @param cond Boolean condition to evaluate - contract passes if true
+ * @param msg Custom error message to display if contract is violated, must be a string literal
+ * @param err POSIX error code to set in errno when contract is violated
+ * @param rate Sampling rate, 0 and 1 check every pass
+ */
+#if CONTRACT_SAMPLE_RANDOM
+#define _CONTRACT_SAMPLED(cond, msg, err, rate) \
+    do { \
+        if (CONTRACT_UNLIKELY(_contract_sample((unsigned long)(rate)))) _CONTRACT_ENFORCE(cond, msg, err); \
+    } while (0)
+#else
+#define _CONTRACT_SAMPLED(cond, msg, err, rate) \
+    do { \
+        static CONTRACT_THREAD_LOCAL unsigned long _contract_pass; \
+        if (CONTRACT_UNLIKELY(_contract_pass-- == 0)) { \
+            _contract_pass = (unsigned long)(rate) > 1 ? (unsigned long)(rate) - 1 : 0; \
+            _CONTRACT_ENFORCE(cond, msg, err); \
+        } \
+    } while (0)
+#endif
+
+/**
+ * @brief Plain contract sampled at CONTRACT_SAMPLE_RATE, for the levels from CONTRACT_SAMPLE_LEVEL up
+ */
+#define _CONTRACT_ENFORCE_SAMPLE(cond, msg, err) _CONTRACT_SAMPLED(cond, msg, err, CONTRACT_SAMPLE_RATE)
+
+/**
+ * @brief Expansion of a sampled contract that has been compiled out, the rate is type checked only
+ */
+#define _CONTRACT_DISABLED_SAMPLED(cond, msg, err, rate) \
+    do { \
+        (void)sizeof(!(cond)); \
+        (void)sizeof(rate); \
+    } while (0)
+
+/**
+ * @brief Per thread serial of contract_scope entries, 0 before the first
+ */
+extern CONTRACT_THREAD_LOCAL unsigned long _contract_scope_serial;
+
+/**
+ * @brief Runs a contract statement only on the first pass through it in each entry of the enclosing contract_scope
+ *
+ * Each site keeps a static per thread copy of the serial of the scope it last completed in, a later pass
+ * in the same scope costs one compare of two words. A violation handled in a CONTRACT_RECOVERABLE build
+ * also counts as the site's pass, so a failed check is reported once per scope entry too. Variadic, the
+ * expansion of the contract it runs has commas of its own.
+ */
+#define _CONTRACT_ONCE(...) \
+    do { \
+        static CONTRACT_THREAD_LOCAL unsigned long _contract_seen; \
+        if (CONTRACT_UNLIKELY(_contract_seen != _contract_scope)) { \
+            __VA_ARGS__; \
+            _contract_seen = _contract_scope; \
+        } \
+    } while (0)
+
+#define _CONTRACT_ENFORCE_ONCE(cond, msg, err) _CONTRACT_ONCE(_CONTRACT_ENFORCE(cond, msg, err))
+
+/**
+ * @brief Expansion of a compiled out contract within CONTRACT_ASSUME_LEVEL, the condition becomes an optimizer hint
+ *
+ * Nothing is checked or reported, the compiler may assume the condition holds from here on.
+ */
+#if CONTRACT_HAVE_ASSUME
+#define _CONTRACT_ASSUMED(cond, msg, err) \
+    do { \
+        CONTRACT_ASSUME(cond); \
+    } while (0)
+#define _CONTRACT_ASSUMED_SAMPLED(cond, msg, err, rate) \
+    do { \
+        CONTRACT_ASSUME(cond); \
+        (void)sizeof(rate); \
+    } while (0)
+#else
+#define _CONTRACT_ASSUMED _CONTRACT_DISABLED
+#define _CONTRACT_ASSUMED_SAMPLED _CONTRACT_DISABLED_SAMPLED
+#endif
+
+// Expansion of each level when compiled out, also used by the groups switched off
+#if CONTRACT_ASSUME_LEVEL >= CONTRACT_LEVEL_REQUIRE
+#define _CONTRACT_REQUIRE_OFF _CONTRACT_ASSUMED
+#define _CONTRACT_REQUIRE_OFF_SAMPLED _CONTRACT_ASSUMED_SAMPLED
+#else
+#define _CONTRACT_REQUIRE_OFF _CONTRACT_DISABLED
+#define _CONTRACT_REQUIRE_OFF_SAMPLED _CONTRACT_DISABLED_SAMPLED
+#endif
+
+#if CONTRACT_ASSUME_LEVEL >= CONTRACT_LEVEL_ENSURE
+#define _CONTRACT_ENSURE_OFF _CONTRACT_ASSUMED
+#define _CONTRACT_ENSURE_OFF_SAMPLED _CONTRACT_ASSUMED_SAMPLED
+#else
+#define _CONTRACT_ENSURE_OFF _CONTRACT_DISABLED
+#define _CONTRACT_ENSURE_OFF_SAMPLED _CONTRACT_DISABLED_SAMPLED
+#endif
+
+#if CONTRACT_ASSUME_LEVEL >= CONTRACT_LEVEL_INVARIANT
+#define _CONTRACT_INVARIANT_OFF _CONTRACT_ASSUMED
+#define _CONTRACT_INVARIANT_OFF_SAMPLED _CONTRACT_ASSUMED_SAMPLED
+#else
+#define _CONTRACT_INVARIANT_OFF _CONTRACT_DISABLED
+#define _CONTRACT_INVARIANT_OFF_SAMPLED _CONTRACT_DISABLED_SAMPLED
+#endif
+
+#if CONTRACT_ASSUME_LEVEL >= CONTRACT_LEVEL_AUDIT
+#define _CONTRACT_AUDIT_OFF _CONTRACT_ASSUMED
+#define _CONTRACT_AUDIT_OFF_SAMPLED _CONTRACT_ASSUMED_SAMPLED
+#else
+#define _CONTRACT_AUDIT_OFF _CONTRACT_DISABLED
+#define _CONTRACT_AUDIT_OFF_SAMPLED _CONTRACT_DISABLED_SAMPLED
+#endif
+
+// Level selection, see contract_config.h
+#if CONTRACT_LEVEL >= CONTRACT_LEVEL_REQUIRE
+#if CONTRACT_SAMPLE_LEVEL <= CONTRACT_LEVEL_REQUIRE
+#define _CONTRACT_REQUIRE _CONTRACT_ENFORCE_SAMPLE
+#else
+#define _CONTRACT_REQUIRE _CONTRACT_ENFORCE
+#endif
+#define _CONTRACT_REQUIRE_SAMPLED _CONTRACT_SAMPLED
+#define _CONTRACT_REQUIRE_ONCE _CONTRACT_ENFORCE_ONCE
+#define _CONTRACT_TRY_REQUIRE _CONTRACT_CHECK
+#else
+#define _CONTRACT_REQUIRE _CONTRACT_REQUIRE_OFF
+#define _CONTRACT_REQUIRE_SAMPLED _CONTRACT_REQUIRE_OFF_SAMPLED
+#define _CONTRACT_REQUIRE_ONCE _CONTRACT_REQUIRE_OFF
+#define _CONTRACT_TRY_REQUIRE _CONTRACT_UNCHECKED
+#endif
+
+#if CONTRACT_LEVEL >= CONTRACT_LEVEL_ENSURE
+#if CONTRACT_SAMPLE_LEVEL <= CONTRACT_LEVEL_ENSURE
+#define _CONTRACT_ENSURE _CONTRACT_ENFORCE_SAMPLE
+#else
+#define _CONTRACT_ENSURE _CONTRACT_ENFORCE
+#endif
+#define _CONTRACT_ENSURE_SAMPLED _CONTRACT_SAMPLED
+#define _CONTRACT_ENSURE_ONCE _CONTRACT_ENFORCE_ONCE
+#define _CONTRACT_TRY_ENSURE _CONTRACT_CHECK
+#else
+#define _CONTRACT_ENSURE _CONTRACT_ENSURE_OFF
+#define _CONTRACT_ENSURE_SAMPLED _CONTRACT_ENSURE_OFF_SAMPLED
+#define _CONTRACT_ENSURE_ONCE _CONTRACT_ENSURE_OFF
+#define _CONTRACT_TRY_ENSURE _CONTRACT_UNCHECKED
+#endif
+
+#if CONTRACT_LEVEL >= CONTRACT_LEVEL_INVARIANT
+#if CONTRACT_SAMPLE_LEVEL <= CONTRACT_LEVEL_INVARIANT
+#define _CONTRACT_INVARIANT _CONTRACT_ENFORCE_SAMPLE
+#else
+#define _CONTRACT_INVARIANT _CONTRACT_ENFORCE
+#endif
+#define _CONTRACT_INVARIANT_SAMPLED _CONTRACT_SAMPLED
+#define _CONTRACT_INVARIANT_ONCE _CONTRACT_ENFORCE_ONCE
+#define _CONTRACT_TRY_INVARIANT _CONTRACT_CHECK
+#else
+#define _CONTRACT_INVARIANT _CONTRACT_INVARIANT_OFF
+#define _CONTRACT_INVARIANT_SAMPLED _CONTRACT_INVARIANT_OFF_SAMPLED
+#define _CONTRACT_INVARIANT_ONCE _CONTRACT_INVARIANT_OFF
+#define _CONTRACT_TRY_INVARIANT _CONTRACT_UNCHECKED
+#endif
+
+#if CONTRACT_LEVEL >= CONTRACT_LEVEL_AUDIT
+#if CONTRACT_SAMPLE_LEVEL <= CONTRACT_LEVEL_AUDIT
+#define _CONTRACT_AUDIT _CONTRACT_ENFORCE_SAMPLE
+#else
+#define _CONTRACT_AUDIT _CONTRACT_ENFORCE
+#endif
+#define _CONTRACT_AUDIT_SAMPLED _CONTRACT_SAMPLED
+#define _CONTRACT_AUDIT_ONCE _CONTRACT_ENFORCE_ONCE
+#define _CONTRACT_TRY_AUDIT _CONTRACT_CHECK
+#else
+#define _CONTRACT_AUDIT _CONTRACT_AUDIT_OFF
+#define _CONTRACT_AUDIT_SAMPLED _CONTRACT_AUDIT_OFF_SAMPLED
+#define _CONTRACT_AUDIT_ONCE _CONTRACT_AUDIT_OFF
+#define _CONTRACT_TRY_AUDIT _CONTRACT_UNCHECKED
+#endif
+
+// Group selection, see contract_config.h
+#if CONTRACT_ENABLE_MEMORY
+#define _CONTRACT_REQUIRE_MEMORY _CONTRACT_REQUIRE
+#define _CONTRACT_TRY_REQUIRE_MEMORY _CONTRACT_TRY_REQUIRE
+#define _CONTRACT_ENSURE_MEMORY _CONTRACT_ENSURE
+#define _CONTRACT_TRY_ENSURE_MEMORY _CONTRACT_TRY_ENSURE
+#else
+#define _CONTRACT_REQUIRE_MEMORY _CONTRACT_REQUIRE_OFF
+#define _CONTRACT_TRY_REQUIRE_MEMORY _CONTRACT_UNCHECKED
+#define _CONTRACT_ENSURE_MEMORY _CONTRACT_ENSURE_OFF
+#define _CONTRACT_TRY_ENSURE_MEMORY _CONTRACT_UNCHECKED
+#endif
+
+#if CONTRACT_ENABLE_FILESYSTEM
+#define _CONTRACT_REQUIRE_FILESYSTEM _CONTRACT_REQUIRE
+#define _CONTRACT_TRY_REQUIRE_FILESYSTEM _CONTRACT_TRY_REQUIRE
+#else
+#define _CONTRACT_REQUIRE_FILESYSTEM _CONTRACT_REQUIRE_OFF
+#define _CONTRACT_TRY_REQUIRE_FILESYSTEM _CONTRACT_UNCHECKED
+#endif
+
+#if CONTRACT_ENABLE_NETWORK
+#define _CONTRACT_REQUIRE_NETWORK _CONTRACT_REQUIRE
+#define _CONTRACT_TRY_REQUIRE_NETWORK _CONTRACT_TRY_REQUIRE
+#else
+#define _CONTRACT_REQUIRE_NETWORK _CONTRACT_REQUIRE_OFF
+#define _CONTRACT_TRY_REQUIRE_NETWORK _CONTRACT_UNCHECKED
+#endif
+
+#if CONTRACT_ENABLE_PROCESS
+#define _CONTRACT_REQUIRE_PROCESS _CONTRACT_REQUIRE
+#define _CONTRACT_TRY_REQUIRE_PROCESS _CONTRACT_TRY_REQUIRE
+#define _CONTRACT_ENSURE_PROCESS _CONTRACT_ENSURE
+#define _CONTRACT_TRY_ENSURE_PROCESS _CONTRACT_TRY_ENSURE
+#else
+#define _CONTRACT_REQUIRE_PROCESS _CONTRACT_REQUIRE_OFF
+#define _CONTRACT_TRY_REQUIRE_PROCESS _CONTRACT_UNCHECKED
+#define _CONTRACT_ENSURE_PROCESS _CONTRACT_ENSURE_OFF
+#define _CONTRACT_TRY_ENSURE_PROCESS _CONTRACT_UNCHECKED
+#endif
+
+#if CONTRACT_ENABLE_MATH
+#define _CONTRACT_REQUIRE_MATH _CONTRACT_REQUIRE
+#define _CONTRACT_TRY_REQUIRE_MATH _CONTRACT_TRY_REQUIRE
+#define _CONTRACT_ENSURE_MATH _CONTRACT_ENSURE
+#define _CONTRACT_TRY_ENSURE_MATH _CONTRACT_TRY_ENSURE
+#else
+#define _CONTRACT_REQUIRE_MATH _CONTRACT_REQUIRE_OFF
+#define _CONTRACT_TRY_REQUIRE_MATH _CONTRACT_UNCHECKED
+#define _CONTRACT_ENSURE_MATH _CONTRACT_ENSURE_OFF
+#define _CONTRACT_TRY_ENSURE_MATH _CONTRACT_UNCHECKED
+#endif
+
+#if CONTRACT_ENABLE_STREAM
+#define _CONTRACT_REQUIRE_STREAM _CONTRACT_REQUIRE
+#define _CONTRACT_TRY_REQUIRE_STREAM _CONTRACT_TRY_REQUIRE
+#else
+#define _CONTRACT_REQUIRE_STREAM _CONTRACT_REQUIRE_OFF
+#define _CONTRACT_TRY_REQUIRE_STREAM _CONTRACT_UNCHECKED
+#endif
 
 // Default Contract
-#define require(cond, msg) _CONTRACT_ENFORCE(cond, msg, POSIX_EINVAL)       // Caller's fault
-#define ensure(cond, msg) _CONTRACT_ENFORCE(cond, msg, POSIX_EINVAL)        // Function's fault
-#define invariant(cond, msg)  _CONTRACT_ENFORCE(cond, msg, POSIX_EINVAL)    // Object's fault
+#define require(cond, msg) _CONTRACT_REQUIRE(cond, msg, POSIX_EINVAL)       // Caller's fault
+#define ensure(cond, msg) _CONTRACT_ENSURE(cond, msg, POSIX_EINVAL)         // Function's fault
+#define invariant(cond, msg)  _CONTRACT_INVARIANT(cond, msg, POSIX_EINVAL)  // Object's fault
+#define audit(cond, msg)  _CONTRACT_AUDIT(cond, msg, POSIX_EINVAL)          // Expensive check, CONTRACT_LEVEL_AUDIT only
+
+/**
+ * @brief Sampled forms for contracts in hot loops, the condition is evaluated on about one pass in rate
+ *
+ * Follow the level of their plain counterpart, see CONTRACT_SAMPLE_RANDOM for how passes are picked.
+ *
+ * @param rate Sampling rate, 0 and 1 check every pass
+ */
+#define require_sampled(cond, msg, rate) _CONTRACT_REQUIRE_SAMPLED(cond, msg, POSIX_EINVAL, rate)
+#define ensure_sampled(cond, msg, rate) _CONTRACT_ENSURE_SAMPLED(cond, msg, POSIX_EINVAL, rate)
+#define invariant_sampled(cond, msg, rate) _CONTRACT_INVARIANT_SAMPLED(cond, msg, POSIX_EINVAL, rate)
+#define audit_sampled(cond, msg, rate) _CONTRACT_AUDIT_SAMPLED(cond, msg, POSIX_EINVAL, rate)
+
+/**
+ * @brief Scope for the once forms, which check a loop invariant condition once per entry rather than per pass
+ *
+ * contract_scope opens a block, each entry of the block gets a new per thread serial, and require_once()
+ * and its siblings inside it check their condition on their first pass after the entry only:
+ *
+ *     contract_scope {
+ *         for (i = 0; i < count; i++) {
+ *             require_once(buf != NULL, "NULL buffer!");
+ *             contract_once(invariant(obj->len <= obj->cap, "Length past capacity"));
+ *             ...
+ *         }
+ *     }
+ *
+ * The once forms follow the level of their plain counterparts and only compile inside a contract_scope.
+ * Nested scopes, recursion and other threads each get their own entry, a site passed again by a recursive
+ * entry is checked once more when its outer scope next reaches it. contract_once() wraps any contract
+ * statement, a require_* or ensure_* specialisation included. In a CONTRACT_LEVEL_NONE build the scope is
+ * a plain block and contract_once() its bare contract.
+ *
+ * contract_scope is a one pass for loop, a break directly inside its block leaves the scope.
+ */
+#if CONTRACT_LEVEL > CONTRACT_LEVEL_NONE
+#define contract_scope \
+    for (unsigned long _contract_scope = ++_contract_scope_serial, *_contract_scope_open = &_contract_scope; \
+         _contract_scope_open; _contract_scope_open = NULL)
+#define contract_once(...) _CONTRACT_ONCE(__VA_ARGS__)
+#else
+#define contract_scope
+#define contract_once(...) __VA_ARGS__
+#endif
+
+#define require_once(cond, msg) _CONTRACT_REQUIRE_ONCE(cond, msg, POSIX_EINVAL)
+#define ensure_once(cond, msg) _CONTRACT_ENSURE_ONCE(cond, msg, POSIX_EINVAL)
+#define invariant_once(cond, msg) _CONTRACT_INVARIANT_ONCE(cond, msg, POSIX_EINVAL)
+#define audit_once(cond, msg) _CONTRACT_AUDIT_ONCE(cond, msg, POSIX_EINVAL)
 
 // Contract specialisations ensure_*
 // Memory/Validity Guards
-#define ensure_address(ptr, msg) _CONTRACT_ENFORCE((ptr) != NULL, msg, POSIX_EFAULT)  /// @example ensure_address(result_ptr, "Function failed to allocate memory");
-#define ensure_valid_encoding(valid_cond, msg) _CONTRACT_ENFORCE(valid_cond, msg, POSIX_EILSEQ)  /// @example ensure_valid_encoding(is_valid_utf8(result_str), "Function returned invalid UTF-8");
+#define ensure_address(ptr, msg) _CONTRACT_ENSURE_MEMORY((ptr) != NULL, msg, POSIX_EFAULT)  /// @example ensure_address(result_ptr, "Function failed to allocate memory");
+#define ensure_valid_encoding(valid_cond, msg) _CONTRACT_ENSURE_MEMORY(valid_cond, msg, POSIX_EILSEQ)  /// @example ensure_valid_encoding(contract_utf8_valid(result_str, strlen(result_str)), "Function returned invalid UTF-8"), or ensure_utf8() from contract_utf8.h
 
 // Mathematical Guarantees
-#define ensure_fail(cond, msg)  _CONTRACT_ENFORCE(!cond, msg, POSIX_SUCCESS);
-#define ensure_in_range(val, min, max, msg) _CONTRACT_ENFORCE((val) >= (min) && (val) <= (max), msg, POSIX_ERANGE)  /// @example ensure_in_range(returned_value, 0, 100, "Function result out of expected bounds");
-#define ensure_no_overflow(val, msg) _CONTRACT_ENFORCE((val) != INT_MAX && (val) != LONG_MAX, msg, POSIX_EOVERFLOW)  /// @example ensure_no_overflow(result, "Function computation overflowed");
+#define ensure_fail(cond, msg)  _CONTRACT_ENSURE_MATH(!(cond), msg, POSIX_SUCCESS)
+#define ensure_in_range(val, min, max, msg) _CONTRACT_ENSURE_MATH((val) >= (min) && (val) <= (max), msg, POSIX_ERANGE)  /// @example ensure_in_range(returned_value, 0, 100, "Function result out of expected bounds");
+// ensure_no_overflow() only spots a result saturated at INT_MAX or LONG_MAX, require_add_ok() and friends
+// in contract_overflow.h catch the overflow itself
+#define ensure_no_overflow(val, msg) _CONTRACT_ENSURE_MATH((val) != INT_MAX && (val) != LONG_MAX, msg, POSIX_EOVERFLOW)  /// @example ensure_no_overflow(result, "Function computation overflowed");
 
 // State Consistency
-#define ensure_resource_available(cond, msg) _CONTRACT_ENFORCE(cond, msg, POSIX_EBUSY)  /// @example ensure_resource_available(sem_trywait(&sem) == 0, "Function failed to acquire required resource");
-#define ensure_mutex_consistent(cond, msg) _CONTRACT_ENFORCE(cond, msg, POSIX_EDEADLK)  /// @example ensure_mutex_consistent(pthread_mutex_consistent(&mutex) == 0, "Mutex state inconsistent after function call");
+#define ensure_resource_available(cond, msg) _CONTRACT_ENSURE_PROCESS(cond, msg, POSIX_EBUSY)  /// @example ensure_resource_available(sem_trywait(&sem) == 0, "Function failed to acquire required resource");
+#define ensure_mutex_consistent(cond, msg) _CONTRACT_ENSURE_PROCESS(cond, msg, POSIX_EDEADLK)  /// @example ensure_mutex_consistent(pthread_mutex_consistent(&mutex) == 0, "Mutex state inconsistent after function call");
 
 // Contract specialisations require_*
 // Process/System Contracts
-#define require_arg_list(cond, msg) _CONTRACT_ENFORCE(cond, msg, POSIX_E2BIG)  /// @example require_arg_list(argv_size < 4096, "Argument list exceeds system limit");
-#define require_id_valid(cond, msg) _CONTRACT_ENFORCE(cond, msg, POSIX_EIDRM)  /// @example require_id_valid(shm_id != -1, "Invalid shared memory ID");
-#define require_process(cond, msg) _CONTRACT_ENFORCE(cond, msg, POSIX_ESRCH)  /// @example require_process(kill(pid, 0) == 0, "Target process does not exist");
-#define require_no_deadlock(cond, msg) _CONTRACT_ENFORCE(cond, msg, POSIX_EDEADLK)  /// @example require_no_deadlock(!mutex_locked, "Potential deadlock detected");
-#define require_not_canceled(cond, msg) _CONTRACT_ENFORCE(cond, msg, POSIX_ECANCELED)  /// @example require_not_canceled(!thread_canceled, "Operation canceled by thread termination");
+#define require_arg_list(cond, msg) _CONTRACT_REQUIRE_PROCESS(cond, msg, POSIX_E2BIG)  /// @example require_arg_list(argv_size < 4096, "Argument list exceeds system limit");
+#define require_id_valid(cond, msg) _CONTRACT_REQUIRE_PROCESS(cond, msg, POSIX_EIDRM)  /// @example require_id_valid(shm_id != -1, "Invalid shared memory ID");
+#define require_process(cond, msg) _CONTRACT_REQUIRE_PROCESS(cond, msg, POSIX_ESRCH)  /// @example require_process(kill(pid, 0) == 0, "Target process does not exist");
+#define require_no_deadlock(cond, msg) _CONTRACT_REQUIRE_PROCESS(cond, msg, POSIX_EDEADLK)  /// @example require_no_deadlock(!mutex_locked, "Potential deadlock detected");
+#define require_not_canceled(cond, msg) _CONTRACT_REQUIRE_PROCESS(cond, msg, POSIX_ECANCELED)  /// @example require_not_canceled(!thread_canceled, "Operation canceled by thread termination");
 
 // Filesystem Contracts
-#define require_fd(cond, msg) _CONTRACT_ENFORCE(cond, msg, POSIX_EBADF)  /// @example require_fd(fd >= 0, "Invalid file descriptor");
-#define require_exists(cond, msg) _CONTRACT_ENFORCE(cond, msg, POSIX_ENOENT)  /// @example require_exists(access(path, F_OK) == 0, "File does not exist");
-#define require_not_dir(cond, msg) _CONTRACT_ENFORCE(cond, msg, POSIX_EISDIR)  /// @example require_not_dir(!S_ISDIR(st.st_mode), "Path must not be a directory");
-#define require_is_dir(cond, msg) _CONTRACT_ENFORCE(cond, msg, POSIX_ENOTDIR)  /// @example require_is_dir(S_ISDIR(st.st_mode), "Path must be a directory");
-#define require_no_loops(cond, msg) _CONTRACT_ENFORCE(cond, msg, POSIX_ELOOP)  /// @example require_no_loops(symlink_depth < 10, "Symbolic link recursion detected");
-#define require_writable(cond, msg) _CONTRACT_ENFORCE(cond, msg, POSIX_EROFS)  /// @example require_writable(access(path, W_OK) == 0, "Filesystem is read-only");
-#define require_empty_dir(cond, msg) _CONTRACT_ENFORCE(cond, msg, POSIX_ENOTEMPTY)  /// @example require_empty_dir(is_dir_empty(dir), "Directory must be empty");
-#define require_regular_file(cond, msg) _CONTRACT_ENFORCE(cond, msg, POSIX_EINVAL)  /// @example require_regular_file(S_ISREG(st.st_mode), "Must be a regular file");
-#define require_not_fifo(cond, msg) _CONTRACT_ENFORCE(cond, msg, POSIX_ENXIO)  /// @example require_not_fifo(!S_ISFIFO(st.st_mode), "Cannot operate on named pipes");
-#define require_permission(cond, msg) _CONTRACT_ENFORCE(cond, msg, POSIX_EPERM)  /// @example require_permission(geteuid() == 0, "Root privileges required");
-#define require_io_success(cond, msg) _CONTRACT_ENFORCE(cond, msg, POSIX_EIO)  /// @example require_io_success(bytes_written == expected, "Disk write failed");
-#define require_device(cond, msg) _CONTRACT_ENFORCE(cond, msg, POSIX_ENODEV)  /// @example require_device(S_ISBLK(st.st_mode), "Not a block device");
-#define require_not_busy(cond, msg) _CONTRACT_ENFORCE(cond, msg, POSIX_ETXTBSY)  /// @example require_not_busy(flock(fd, LOCK_EX|LOCK_NB) == 0, "File is locked by another process");
-#define require_file_size(cond, msg) _CONTRACT_ENFORCE(cond, msg, POSIX_EFBIG)  /// @example require_file_size(st.st_size <= MAX_SIZE, "File exceeds size limit");
-#define require_name_length(cond, msg) _CONTRACT_ENFORCE(cond, msg, POSIX_ENAMETOOLONG)  /// @example require_name_length(strlen(name) < 255, "Filename too long");
-#define require_same_device(cond, msg) _CONTRACT_ENFORCE(cond, msg, POSIX_EXDEV)  /// @example require_same_device(st1.st_dev == st2.st_dev, "Cross-device operation not allowed");
-#define require_fresh_handle(cond, msg) _CONTRACT_ENFORCE(cond, msg, POSIX_ESTALE)  /// @example require_fresh_handle(fstat(fd, &st) == 0, "File handle is stale");
-#define require_pipe_ready(cond, msg) _CONTRACT_ENFORCE(cond, msg, POSIX_EPIPE)  /// @example require_pipe_ready(write(pipefd[1], &c, 1) != -1, "Pipe broken");
-#define require_valid_encoding(cond, msg) _CONTRACT_ENFORCE(cond, msg, POSIX_EILSEQ)  /// @example require_valid_encoding(mblen(str, MB_CUR_MAX) != -1, "Invalid multibyte sequence");
-#define require_supported(cond, msg) _CONTRACT_ENFORCE(cond, msg, POSIX_ENOTSUP)  /// @example require_supported(has_feature_X(), "Feature not supported");
-#define require_recoverable(cond, msg) _CONTRACT_ENFORCE(cond, msg, POSIX_ENOTRECOVERABLE)  /// @example require_recoverable(state != CORRUPTED, "Unrecoverable state detected");
-#define require_owner_alive(cond, msg) _CONTRACT_ENFORCE(cond, msg, POSIX_EOWNERDEAD)  /// @example require_owner_alive(check_owner(lock), "Lock owner terminated");
+#define require_fd(cond, msg) _CONTRACT_REQUIRE_FILESYSTEM(cond, msg, POSIX_EBADF)  /// @example require_fd(fd >= 0, "Invalid file descriptor");
+#define require_exists(cond, msg) _CONTRACT_REQUIRE_FILESYSTEM(cond, msg, POSIX_ENOENT)  /// @example require_exists(access(path, F_OK) == 0, "File does not exist");
+#define require_not_dir(cond, msg) _CONTRACT_REQUIRE_FILESYSTEM(cond, msg, POSIX_EISDIR)  /// @example require_not_dir(!S_ISDIR(st.st_mode), "Path must not be a directory");
+#define require_is_dir(cond, msg) _CONTRACT_REQUIRE_FILESYSTEM(cond, msg, POSIX_ENOTDIR)  /// @example require_is_dir(S_ISDIR(st.st_mode), "Path must be a directory");
+#define require_no_loops(cond, msg) _CONTRACT_REQUIRE_FILESYSTEM(cond, msg, POSIX_ELOOP)  /// @example require_no_loops(symlink_depth < 10, "Symbolic link recursion detected");
+#define require_writable(cond, msg) _CONTRACT_REQUIRE_FILESYSTEM(cond, msg, POSIX_EROFS)  /// @example require_writable(access(path, W_OK) == 0, "Filesystem is read-only");
+#define require_empty_dir(cond, msg) _CONTRACT_REQUIRE_FILESYSTEM(cond, msg, POSIX_ENOTEMPTY)  /// @example require_empty_dir(is_dir_empty(dir), "Directory must be empty");
+#define require_regular_file(cond, msg) _CONTRACT_REQUIRE_FILESYSTEM(cond, msg, POSIX_EINVAL)  /// @example require_regular_file(S_ISREG(st.st_mode), "Must be a regular file");
+#define require_not_fifo(cond, msg) _CONTRACT_REQUIRE_FILESYSTEM(cond, msg, POSIX_ENXIO)  /// @example require_not_fifo(!S_ISFIFO(st.st_mode), "Cannot operate on named pipes");
+#define require_permission(cond, msg) _CONTRACT_REQUIRE_FILESYSTEM(cond, msg, POSIX_EPERM)  /// @example require_permission(geteuid() == 0, "Root privileges required");
+#define require_io_success(cond, msg) _CONTRACT_REQUIRE_FILESYSTEM(cond, msg, POSIX_EIO)  /// @example require_io_success(bytes_written == expected, "Disk write failed");
+#define require_device(cond, msg) _CONTRACT_REQUIRE_FILESYSTEM(cond, msg, POSIX_ENODEV)  /// @example require_device(S_ISBLK(st.st_mode), "Not a block device");
+#define require_not_busy(cond, msg) _CONTRACT_REQUIRE_FILESYSTEM(cond, msg, POSIX_ETXTBSY)  /// @example require_not_busy(flock(fd, LOCK_EX|LOCK_NB) == 0, "File is locked by another process");
+#define require_file_size(cond, msg) _CONTRACT_REQUIRE_FILESYSTEM(cond, msg, POSIX_EFBIG)  /// @example require_file_size(st.st_size <= MAX_SIZE, "File exceeds size limit");
+#define require_name_length(cond, msg) _CONTRACT_REQUIRE_FILESYSTEM(cond, msg, POSIX_ENAMETOOLONG)  /// @example require_name_length(strlen(name) < 255, "Filename too long");
+#define require_same_device(cond, msg) _CONTRACT_REQUIRE_FILESYSTEM(cond, msg, POSIX_EXDEV)  /// @example require_same_device(st1.st_dev == st2.st_dev, "Cross-device operation not allowed");
+#define require_fresh_handle(cond, msg) _CONTRACT_REQUIRE_FILESYSTEM(cond, msg, POSIX_ESTALE)  /// @example require_fresh_handle(fstat(fd, &st) == 0, "File handle is stale");
+#define require_pipe_ready(cond, msg) _CONTRACT_REQUIRE_FILESYSTEM(cond, msg, POSIX_EPIPE)  /// @example require_pipe_ready(write(pipefd[1], &c, 1) != -1, "Pipe broken");
+#define require_valid_encoding(cond, msg) _CONTRACT_REQUIRE_FILESYSTEM(cond, msg, POSIX_EILSEQ)  /// @example require_valid_encoding(mblen(str, MB_CUR_MAX) != -1, "Invalid multibyte sequence");
+#define require_supported(cond, msg) _CONTRACT_REQUIRE_FILESYSTEM(cond, msg, POSIX_ENOTSUP)  /// @example require_supported(has_feature_X(), "Feature not supported");
+#define require_recoverable(cond, msg) _CONTRACT_REQUIRE_FILESYSTEM(cond, msg, POSIX_ENOTRECOVERABLE)  /// @example require_recoverable(state != CORRUPTED, "Unrecoverable state detected");
+#define require_owner_alive(cond, msg) _CONTRACT_REQUIRE_FILESYSTEM(cond, msg, POSIX_EOWNERDEAD)  /// @example require_owner_alive(check_owner(lock), "Lock owner terminated");
 
 // Memory/Address Contracts
-#define require_address(cond, msg) _CONTRACT_ENFORCE(cond, msg, POSIX_EFAULT)  /// @example require_address(ptr != NULL, "Null pointer dereference");
-#define require_mem(cond, msg) _CONTRACT_ENFORCE(cond, msg, POSIX_ENOMEM)  /// @example require_mem(ptr = malloc(size), "Memory allocation failed");
-#define require_aligned(cond, msg) _CONTRACT_ENFORCE(cond, msg, POSIX_EINVAL)  /// @example require_aligned((uintptr_t)ptr % 8 == 0, "Pointer not 8-byte aligned");
+#define require_address(cond, msg) _CONTRACT_REQUIRE_MEMORY(cond, msg, POSIX_EFAULT)  /// @example require_address(ptr != NULL, "Null pointer dereference");
+#define require_mem(cond, msg) _CONTRACT_REQUIRE_MEMORY(cond, msg, POSIX_ENOMEM)  /// @example require_mem(ptr = malloc(size), "Memory allocation failed");
+#define require_aligned(cond, msg) _CONTRACT_REQUIRE_MEMORY(cond, msg, POSIX_EINVAL)  /// @example require_aligned((uintptr_t)ptr % 8 == 0, "Pointer not 8-byte aligned");
 
 // Math/Domain Contracts
-#define require_domain(cond, msg) _CONTRACT_ENFORCE(cond, msg, POSIX_EDOM)  /// @example require_domain(x >= 0, "Square root of negative number");
-#define require_range(cond, msg) _CONTRACT_ENFORCE(cond, msg, POSIX_ERANGE)  /// @example require_range(result <= INT_MAX, "Integer overflow detected");
+#define require_domain(cond, msg) _CONTRACT_REQUIRE_MATH(cond, msg, POSIX_EDOM)  /// @example require_domain(x >= 0, "Square root of negative number");
+#define require_range(cond, msg) _CONTRACT_REQUIRE_MATH(cond, msg, POSIX_ERANGE)  /// @example require_range(result <= INT_MAX, "Integer overflow detected");
 
 
 // Network Contracts
-#define require_not_already_connecting(cond, msg) _CONTRACT_ENFORCE(cond, msg, POSIX_EALREADY)  /// @example require_not_already_connecting(!connecting, "Already connecting to host");
-#define require_host_reachable(cond, msg) _CONTRACT_ENFORCE(cond, msg, POSIX_EHOSTUNREACH)  /// @example require_host_reachable(ping(host) == 0, "Host unreachable");
-#define require_network_up(cond, msg) _CONTRACT_ENFORCE(cond, msg, POSIX_ENETDOWN)  /// @example require_network_up(is_interface_up("eth0"), "Network interface down");
-#define require_no_timeout(cond, msg) _CONTRACT_ENFORCE(cond, msg, POSIX_ETIMEDOUT)  /// @example require_no_timeout(select(fd+1, &readfds, NULL, NULL, &tv) > 0, "Connection timeout");
-#define require_proto_available(cond, msg) _CONTRACT_ENFORCE(cond, msg, POSIX_EPROTONOSUPPORT)  /// @example require_proto_available(socket(AF_INET, SOCK_RAW, proto) != -1, "Protocol not supported");
+#define require_not_already_connecting(cond, msg) _CONTRACT_REQUIRE_NETWORK(cond, msg, POSIX_EALREADY)  /// @example require_not_already_connecting(!connecting, "Already connecting to host");
+#define require_host_reachable(cond, msg) _CONTRACT_REQUIRE_NETWORK(cond, msg, POSIX_EHOSTUNREACH)  /// @example require_host_reachable(ping(host) == 0, "Host unreachable");
+#define require_network_up(cond, msg) _CONTRACT_REQUIRE_NETWORK(cond, msg, POSIX_ENETDOWN)  /// @example require_network_up(is_interface_up("eth0"), "Network interface down");
+#define require_no_timeout(cond, msg) _CONTRACT_REQUIRE_NETWORK(cond, msg, POSIX_ETIMEDOUT)  /// @example require_no_timeout(select(fd+1, &readfds, NULL, NULL, &tv) > 0, "Connection timeout");
+#define require_proto_available(cond, msg) _CONTRACT_REQUIRE_NETWORK(cond, msg, POSIX_EPROTONOSUPPORT)  /// @example require_proto_available(socket(AF_INET, SOCK_RAW, proto) != -1, "Protocol not supported");
+
+// Streams Contracts (Obscure POSIX)
+#define require_stream_alive(cond, msg) _CONTRACT_REQUIRE_STREAM(cond, msg, POSIX_ENODEV)  /// @example require_stream_alive(isatty(fileno(stdin)), "Standard input not a terminal");
+
+// Recoverable contracts try_*, expression forms of the contracts above evaluating to their posix_error_t
+// e.g. posix_error_t err = try_require_mem(buf != NULL, "FAILED memory allocation!"); see CONTRACT_RECOVERABLE
+
+// Default Contract
+#define try_require(cond, msg) _CONTRACT_TRY_REQUIRE(cond, msg, POSIX_EINVAL)
+#define try_ensure(cond, msg) _CONTRACT_TRY_ENSURE(cond, msg, POSIX_EINVAL)
+#define try_invariant(cond, msg) _CONTRACT_TRY_INVARIANT(cond, msg, POSIX_EINVAL)
+#define try_audit(cond, msg) _CONTRACT_TRY_AUDIT(cond, msg, POSIX_EINVAL)
+
+// Memory/Validity Guards
+#define try_ensure_address(ptr, msg) _CONTRACT_TRY_ENSURE_MEMORY((ptr) != NULL, msg, POSIX_EFAULT)
+#define try_ensure_valid_encoding(valid_cond, msg) _CONTRACT_TRY_ENSURE_MEMORY(valid_cond, msg, POSIX_EILSEQ)
+
+// Mathematical Guarantees
+#define try_ensure_fail(cond, msg) _CONTRACT_TRY_ENSURE_MATH(!(cond), msg, POSIX_SUCCESS)
+#define try_ensure_in_range(val, min, max, msg) _CONTRACT_TRY_ENSURE_MATH((val) >= (min) && (val) <= (max), msg, POSIX_ERANGE)
+#define try_ensure_no_overflow(val, msg) _CONTRACT_TRY_ENSURE_MATH((val) != INT_MAX && (val) != LONG_MAX, msg, POSIX_EOVERFLOW)
+
+// State Consistency
+#define try_ensure_resource_available(cond, msg) _CONTRACT_TRY_ENSURE_PROCESS(cond, msg, POSIX_EBUSY)
+#define try_ensure_mutex_consistent(cond, msg) _CONTRACT_TRY_ENSURE_PROCESS(cond, msg, POSIX_EDEADLK)
+
+// Process/System Contracts
+#define try_require_arg_list(cond, msg) _CONTRACT_TRY_REQUIRE_PROCESS(cond, msg, POSIX_E2BIG)
+#define try_require_id_valid(cond, msg) _CONTRACT_TRY_REQUIRE_PROCESS(cond, msg, POSIX_EIDRM)
+#define try_require_process(cond, msg) _CONTRACT_TRY_REQUIRE_PROCESS(cond, msg, POSIX_ESRCH)
+#define try_require_no_deadlock(cond, msg) _CONTRACT_TRY_REQUIRE_PROCESS(cond, msg, POSIX_EDEADLK)
+#define try_require_not_canceled(cond, msg) _CONTRACT_TRY_REQUIRE_PROCESS(cond, msg, POSIX_ECANCELED)
+
+// Filesystem Contracts
+#define try_require_fd(cond, msg) _CONTRACT_TRY_REQUIRE_FILESYSTEM(cond, msg, POSIX_EBADF)
+#define try_require_exists(cond, msg) _CONTRACT_TRY_REQUIRE_FILESYSTEM(cond, msg, POSIX_ENOENT)
+#define try_require_not_dir(cond, msg) _CONTRACT_TRY_REQUIRE_FILESYSTEM(cond, msg, POSIX_EISDIR)
+#define try_require_is_dir(cond, msg) _CONTRACT_TRY_REQUIRE_FILESYSTEM(cond, msg, POSIX_ENOTDIR)
+#define try_require_no_loops(cond, msg) _CONTRACT_TRY_REQUIRE_FILESYSTEM(cond, msg, POSIX_ELOOP)
+#define try_require_writable(cond, msg) _CONTRACT_TRY_REQUIRE_FILESYSTEM(cond, msg, POSIX_EROFS)
+#define try_require_empty_dir(cond, msg) _CONTRACT_TRY_REQUIRE_FILESYSTEM(cond, msg, POSIX_ENOTEMPTY)
+#define try_require_regular_file(cond, msg) _CONTRACT_TRY_REQUIRE_FILESYSTEM(cond, msg, POSIX_EINVAL)
+#define try_require_not_fifo(cond, msg) _CONTRACT_TRY_REQUIRE_FILESYSTEM(cond, msg, POSIX_ENXIO)
+#define try_require_permission(cond, msg) _CONTRACT_TRY_REQUIRE_FILESYSTEM(cond, msg, POSIX_EPERM)
+#define try_require_io_success(cond, msg) _CONTRACT_TRY_REQUIRE_FILESYSTEM(cond, msg, POSIX_EIO)
+#define try_require_device(cond, msg) _CONTRACT_TRY_REQUIRE_FILESYSTEM(cond, msg, POSIX_ENODEV)
+#define try_require_not_busy(cond, msg) _CONTRACT_TRY_REQUIRE_FILESYSTEM(cond, msg, POSIX_ETXTBSY)
+#define try_require_file_size(cond, msg) _CONTRACT_TRY_REQUIRE_FILESYSTEM(cond, msg, POSIX_EFBIG)
+#define try_require_name_length(cond, msg) _CONTRACT_TRY_REQUIRE_FILESYSTEM(cond, msg, POSIX_ENAMETOOLONG)
+#define try_require_same_device(cond, msg) _CONTRACT_TRY_REQUIRE_FILESYSTEM(cond, msg, POSIX_EXDEV)
+#define try_require_fresh_handle(cond, msg) _CONTRACT_TRY_REQUIRE_FILESYSTEM(cond, msg, POSIX_ESTALE)
+#define try_require_pipe_ready(cond, msg) _CONTRACT_TRY_REQUIRE_FILESYSTEM(cond, msg, POSIX_EPIPE)
+#define try_require_valid_encoding(cond, msg) _CONTRACT_TRY_REQUIRE_FILESYSTEM(cond, msg, POSIX_EILSEQ)
+#define try_require_supported(cond, msg) _CONTRACT_TRY_REQUIRE_FILESYSTEM(cond, msg, POSIX_ENOTSUP)
+#define try_require_recoverable(cond, msg) _CONTRACT_TRY_REQUIRE_FILESYSTEM(cond, msg, POSIX_ENOTRECOVERABLE)
+#define try_require_owner_alive(cond, msg) _CONTRACT_TRY_REQUIRE_FILESYSTEM(cond, msg, POSIX_EOWNERDEAD)
+
+// Memory/Address Contracts
+#define try_require_address(cond, msg) _CONTRACT_TRY_REQUIRE_MEMORY(cond, msg, POSIX_EFAULT)
+#define try_require_mem(cond, msg) _CONTRACT_TRY_REQUIRE_MEMORY(cond, msg, POSIX_ENOMEM)
+#define try_require_aligned(cond, msg) _CONTRACT_TRY_REQUIRE_MEMORY(cond, msg, POSIX_EINVAL)
+
+// Math/Domain Contracts
+#define try_require_domain(cond, msg) _CONTRACT_TRY_REQUIRE_MATH(cond, msg, POSIX_EDOM)
+#define try_require_range(cond, msg) _CONTRACT_TRY_REQUIRE_MATH(cond, msg, POSIX_ERANGE)
+
+// Network Contracts
+#define try_require_not_already_connecting(cond, msg) _CONTRACT_TRY_REQUIRE_NETWORK(cond, msg, POSIX_EALREADY)
+#define try_require_host_reachable(cond, msg) _CONTRACT_TRY_REQUIRE_NETWORK(cond, msg, POSIX_EHOSTUNREACH)
+#define try_require_network_up(cond, msg) _CONTRACT_TRY_REQUIRE_NETWORK(cond, msg, POSIX_ENETDOWN)
+#define try_require_no_timeout(cond, msg) _CONTRACT_TRY_REQUIRE_NETWORK(cond, msg, POSIX_ETIMEDOUT)
+#define try_require_proto_available(cond, msg) _CONTRACT_TRY_REQUIRE_NETWORK(cond, msg, POSIX_EPROTONOSUPPORT)
 
 // Streams Contracts (Obscure POSIX)
-#define require_stream_alive(cond, msg) _CONTRACT_ENFORCE(cond, msg, POSIX_ENODEV)  /// @example require_stream_alive(isatty(fileno(stdin)), "Standard input not a terminal");
+#define try_require_stream_alive(cond, msg) _CONTRACT_TRY_REQUIRE_STREAM(cond, msg, POSIX_ENODEV)
 
 #endif
@@ -0,0 +1,239 @@
+#include "contract_arena.h"
+#include <stdint.h>
+#include <string.h>
+
+#define CONTRACT_ARENA_CHECKED (CONTRACT_LEVEL >= CONTRACT_LEVEL_INVARIANT)
+#define CONTRACT_ARENA_POISON (CONTRACT_LEVEL >= CONTRACT_LEVEL_AUDIT)
+
+#define ARENA_MAGIC 0xA4E7A5B1UL    // leads every block header
+#define ARENA_CANARY_LEN 4
+#define ARENA_POISON_BYTE 0xDD
+#define POOL_FREED 0xF4EEB10CUL     // tags a free pool block, mixed with the pool's address
+
+#if CONTRACT_ARENA_CHECKED
+static const unsigned char arena_canary[ARENA_CANARY_LEN] = { 0xCA, 0xFE, 0xD0, 0x0D };
+#endif
+
+/*
+ * Framing of a checked arena block, copied with memcpy() so neither needs aligning:
+ *     [header][pad bytes][size bytes of data][canary]
+ * The next header follows the canary directly.
+ */
+typedef struct {
+    unsigned long magic;
+    size_t size;
+    size_t pad;
+} arena_header_t;
+
+static int is_pow2(size_t x) {
+    return x != 0 && (x & (x - 1)) == 0;
+}
+
+#if CONTRACT_ARENA_POISON
+static int is_poison(const unsigned char *p, size_t n) {
+    size_t i;
+
+    for (i = 0; i < n; i++) {
+        if (p[i] != ARENA_POISON_BYTE) return 0;
+    }
+    return 1;
+}
+#endif
+
+void contract_arena_init(contract_arena_t *arena, void *buf, size_t size) {
+    require_address(buf != NULL, "NULL arena buffer");
+    require_range(size > 0, "Empty arena");
+    arena->base = (unsigned char *)buf;
+    arena->size = size;
+    arena->used = 0;
+    arena->poisoned = 0;
+    arena->blocks = 0;
+}
+
+void *contract_arena_alloc(contract_arena_t *arena, size_t size, size_t align) {
+    uintptr_t start, data;
+    size_t left = arena->size - arena->used;
+    int fits;
+
+    if (align == 0) align = sizeof(void *);
+    if (try_require_range(size > 0 && size <= arena->size, "Arena allocation size out of range")) return NULL;
+    if (try_require_aligned(is_pow2(align), "Arena alignment not a power of two")) return NULL;
+
+    start = (uintptr_t)(arena->base + arena->used);
+#if CONTRACT_ARENA_CHECKED
+    data = (start + sizeof(arena_header_t) + align - 1) & ~(uintptr_t)(align - 1);
+    fits = left >= (size_t)(data - start) && left - (size_t)(data - start) >= size + ARENA_CANARY_LEN;
+#else
+    data = (start + align - 1) & ~(uintptr_t)(align - 1);
+    fits = left >= (size_t)(data - start) && left - (size_t)(data - start) >= size;
+#endif
+    if (!fits) {
+        (void)try_require_mem(fits, "Arena exhausted");
+        return NULL;
+    }
+#if CONTRACT_ARENA_CHECKED
+    {
+        arena_header_t hdr;
+
+        hdr.magic = ARENA_MAGIC;
+        hdr.size = size;
+        hdr.pad = (size_t)(data - start - sizeof(arena_header_t));
+        memcpy((void *)start, &hdr, sizeof(hdr));
+    }
+    memcpy((unsigned char *)data + size, arena_canary, ARENA_CANARY_LEN);
+    arena->used = (size_t)(data - (uintptr_t)arena->base) + size + ARENA_CANARY_LEN;
+#else
+    arena->used = (size_t)(data - (uintptr_t)arena->base) + size;
+#endif
+    arena->blocks++;
+    return (void *)data;
+}
+
+#if CONTRACT_ARENA_CHECKED
+// Walks the blocks in allocation order, naming the first with a broken header or canary
+static void arena_check_canaries(const contract_arena_t *arena) {
+    size_t off = 0;
+    unsigned long block = 0;
+    arena_header_t hdr;
+    const unsigned char *data;
+    int ok;
+
+    while (off < arena->used) {
+        size_t left = arena->used - off;
+
+        // every bound is tested before it is used, a broken header must not send the walk out of the arena
+        ok = left >= sizeof(hdr);
+        if (ok) {
+            memcpy(&hdr, arena->base + off, sizeof(hdr));
+            left -= sizeof(hdr);
+            ok = hdr.magic == ARENA_MAGIC && hdr.size <= left && hdr.pad <= left - hdr.size
+                && left - hdr.size - hdr.pad >= ARENA_CANARY_LEN;
+        }
+        if (ok) {
+            data = arena->base + off + sizeof(hdr) + hdr.pad;
+            ok = memcmp(data + hdr.size, arena_canary, ARENA_CANARY_LEN) == 0;
+        }
+        if (CONTRACT_UNLIKELY(!ok)) {
+            _contract_set_index((long)block);
+            _CONTRACT_INVARIANT(ok, "Arena block overrun, header or canary overwritten", POSIX_EFAULT);
+            return;     // the chain is lost past a broken header
+        }
+        off = (size_t)(data - arena->base) + hdr.size + ARENA_CANARY_LEN;
+        block++;
+    }
+}
+#endif
+
+void contract_arena_reset(contract_arena_t *arena) {
+#if CONTRACT_ARENA_CHECKED
+    arena_check_canaries(arena);
+#endif
+#if CONTRACT_ARENA_POISON
+    // memory released by earlier resets and not handed out since must still be poison
+    if (arena->poisoned > arena->used) {
+        _CONTRACT_AUDIT(is_poison(arena->base + arena->used, arena->poisoned - arena->used),
+            "Arena memory written after reset", POSIX_EFAULT);
+    }
+    memset(arena->base, ARENA_POISON_BYTE, arena->used);
+    if (arena->used > arena->poisoned) arena->poisoned = arena->used;
+#endif
+    arena->used = 0;
+    arena->blocks = 0;
+}
+
+size_t contract_arena_used(const contract_arena_t *arena) {
+    return arena->used;
+}
+
+// Word 0 of a free block links the free list, word 1 holds the freed tag
+#if CONTRACT_ARENA_CHECKED
+static uintptr_t pool_tag(const contract_pool_t *pool) {
+    return (uintptr_t)pool ^ POOL_FREED;
+}
+#endif
+
+static int pool_owns(const contract_pool_t *pool, const void *ptr) {
+    const unsigned char *p = (const unsigned char *)ptr;
+
+    return p >= pool->base && p < pool->base + pool->block * pool->count && (size_t)(p - pool->base) % pool->block == 0;
+}
+
+static void pool_release(contract_pool_t *pool, void *ptr) {
+    void **word = (void **)ptr;
+
+    word[0] = pool->free;
+#if CONTRACT_ARENA_CHECKED
+    ((uintptr_t *)ptr)[1] = pool_tag(pool);
+#endif
+#if CONTRACT_ARENA_POISON
+    memset(word + 2, ARENA_POISON_BYTE, pool->block - 2 * sizeof(void *));
+#endif
+    pool->free = ptr;
+}
+
+static void pool_rebuild(contract_pool_t *pool) {
+    size_t i = pool->count;
+
+    pool->free = NULL;
+    pool->live = 0;
+    while (i-- > 0) pool_release(pool, pool->base + i * pool->block);
+}
+
+void contract_pool_init(contract_pool_t *pool, void *buf, size_t size, size_t block) {
+    require_address(buf != NULL, "NULL pool buffer");
+    require_aligned((uintptr_t)buf % sizeof(void *) == 0, "Pool buffer not pointer aligned");
+    if (block < 2 * sizeof(void *)) block = 2 * sizeof(void *);
+    block = (block + sizeof(void *) - 1) & ~(sizeof(void *) - 1);
+    require_range(size >= block, "Pool buffer smaller than a block");
+    pool->base = (unsigned char *)buf;
+    pool->block = block;
+    pool->count = size / block;
+    pool_rebuild(pool);
+}
+
+void *contract_pool_alloc(contract_pool_t *pool) {
+    void **block = (void **)pool->free;
+
+    if (!block) {
+        (void)try_require_mem(block != NULL, "Pool exhausted");
+        return NULL;
+    }
+#if CONTRACT_ARENA_CHECKED
+    _CONTRACT_INVARIANT(((uintptr_t *)block)[1] == pool_tag(pool) && (block[0] == NULL || pool_owns(pool, block[0])),
+        "Pool free list corrupt, block written after free", POSIX_EFAULT);
+    ((uintptr_t *)block)[1] = 0;
+#endif
+    pool->free = block[0];
+    pool->live++;
+    return block;
+}
+
+void contract_pool_free(contract_pool_t *pool, void *ptr) {
+    if (!ptr) return;
+    if (try_require_address(pool_owns(pool, ptr), "Pointer not a block of this pool")) return;
+#if CONTRACT_ARENA_CHECKED
+    if (try_require(((uintptr_t *)ptr)[1] != pool_tag(pool), "Pool block freed twice")) return;
+#endif
+    pool_release(pool, ptr);
+    pool->live--;
+}
+
+void contract_pool_reset(contract_pool_t *pool) {
+#if CONTRACT_ARENA_POISON
+    const void *p;
+    size_t n = 0;
+
+    // free blocks keep their tag and poison, the walk stops at a broken link rather than follow it
+    for (p = pool->free; p && n < pool->count; p = *(void *const *)p, n++) {
+        int ok = ((const uintptr_t *)p)[1] == pool_tag(pool)
+            && is_poison((const unsigned char *)p + 2 * sizeof(void *), pool->block - 2 * sizeof(void *))
+            && (*(void *const *)p == NULL || pool_owns(pool, *(void *const *)p));
+        if (CONTRACT_UNLIKELY(!ok)) {
+            _contract_set_index((long)(((const unsigned char *)p - pool->base) / pool->block));
+            _CONTRACT_AUDIT(ok, "Pool block written after free", POSIX_EFAULT);
+            break;
+        }
+    }
+#endif
+    pool_rebuild(pool);
+}
@@ -0,0 +1,107 @@
+/**
+ * @file contract_arena.h
+ * @brief Bump arena and fixed block pool with level controlled alignment, bounds, double free and canary contracts
+ * @version 0.1.4
+ * @license MIT
+ * @author Jeremy Thornton
+ */
+#ifndef CONTRACT_ARENA_H
+#define CONTRACT_ARENA_H
+
+#include "contract.h"
+
+/**
+ * @brief Contracts of the allocators, by the level the library is built at
+ *
+ * - CONTRACT_LEVEL_REQUIRE  sizes in range and alignments a power of two (ERANGE, EINVAL), space left
+ *                            (ENOMEM, NULL once recovered), a freed pointer from the pool and on a block (EFAULT)
+ * - CONTRACT_LEVEL_INVARIANT each arena block is framed by a header and a trailing canary, all checked
+ *                            together by contract_arena_reset(), and a pool block freed twice fails (EINVAL)
+ * - CONTRACT_LEVEL_AUDIT     released memory is poisoned, and the next reset checks that the part not handed
+ *                            out again is still poison, catching writes through stale pointers
+ *
+ * An allocation costs a bump, or a free list pop, plus a few stores for the canaries, the scans run at
+ * reset only. A failed canary names the offending block by its allocation order as the report's index.
+ */
+
+/**
+ * @brief Bump allocator over a caller's buffer, released all at once by contract_arena_reset()
+ */
+typedef struct {
+    unsigned char *base;
+    size_t size;
+    size_t used;                /**< Bytes handed out since the last reset, framing included */
+    size_t poisoned;            /**< End of the region poisoned by the last resets */
+    unsigned long blocks;       /**< Allocations since the last reset */
+} contract_arena_t;
+
+/**
+ * @brief Prepares an arena over buf
+ *
+ * @param arena Arena to initialise
+ * @param buf Memory the arena hands out, owned by the caller
+ * @param size Bytes in buf
+ */
+void contract_arena_init(contract_arena_t *arena, void *buf, size_t size);
+
+/**
+ * @brief Allocates size bytes aligned to align
+ *
+ * @param arena Arena to allocate from
+ * @param size Bytes wanted, 1 up to the arena size
+ * @param align Power of two alignment, 0 for that of a pointer
+ * @return The block, NULL when a recovered contract failed
+ */
+void *contract_arena_alloc(contract_arena_t *arena, size_t size, size_t align);
+
+/**
+ * @brief Releases every block, after checking their canaries in bulk
+ */
+void contract_arena_reset(contract_arena_t *arena);
+
+/**
+ * @brief Bytes in use, including the framing of the checked levels
+ */
+size_t contract_arena_used(const contract_arena_t *arena);
+
+/**
+ * @brief Allocator of equal sized blocks over a caller's buffer, with a free list threaded through them
+ */
+typedef struct {
+    unsigned char *base;
+    size_t block;               /**< Block stride, the requested size rounded up */
+    size_t count;
+    void *free;                 /**< First free block, NULL when exhausted */
+    size_t live;                /**< Blocks allocated and not yet freed */
+} contract_pool_t;
+
+/**
+ * @brief Prepares a pool of size / block blocks over buf, every one free
+ *
+ * @param pool Pool to initialise
+ * @param buf Memory of the blocks, owned by the caller
+ * @param size Bytes in buf
+ * @param block Bytes per block, rounded up to a multiple of a pointer and to two pointers at least
+ */
+void contract_pool_init(contract_pool_t *pool, void *buf, size_t size, size_t block);
+
+/**
+ * @brief Takes a free block
+ *
+ * @return Block of at least the pool's block size, pointer aligned, NULL when a recovered contract failed
+ */
+void *contract_pool_alloc(contract_pool_t *pool);
+
+/**
+ * @brief Returns a block to the pool
+ *
+ * @param ptr Block from contract_pool_alloc() on this pool, NULL is ignored
+ */
+void contract_pool_free(contract_pool_t *pool, void *ptr);
+
+/**
+ * @brief Frees every block, checking in the audit build that the free ones were not written to
+ */
+void contract_pool_reset(contract_pool_t *pool);
+
+#endif
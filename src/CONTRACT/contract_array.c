@@ -0,0 +1,413 @@
+#include "contract_array.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__)))
+#include <emmintrin.h>
+#include <immintrin.h>
+#define CONTRACT_SIMD_SSE2 1
+#define CONTRACT_SIMD_AVX2 1
+#elif defined(_MSC_VER) && (defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define CONTRACT_SIMD_SSE2 1
+#elif (defined(__GNUC__) || defined(__clang__)) && defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define CONTRACT_SIMD_NEON 1
+#endif
+
+#ifndef CONTRACT_SIMD_SSE2
+#define CONTRACT_SIMD_SSE2 0
+#endif
+#ifndef CONTRACT_SIMD_AVX2
+#define CONTRACT_SIMD_AVX2 0
+#endif
+#ifndef CONTRACT_SIMD_NEON
+#define CONTRACT_SIMD_NEON 0
+#endif
+
+// Elements tested per reduction, a failing buffer is abandoned after at most one block
+#define CONTRACT_ARRAY_BLOCK 64
+
+#define CONTRACT_FLOAT_EXP 0x7F800000UL
+#define CONTRACT_DOUBLE_EXP_HI 0x7FF00000UL
+
+static unsigned long contract_float_bits(const float *v) {
+    union { float f; unsigned long u; } bits;
+
+    bits.u = 0;
+    bits.f = *v;
+    return bits.u & 0xFFFFFFFFUL;
+}
+
+// High 32 bits of an IEEE double, whatever the byte order
+static unsigned long contract_double_hi(const double *v) {
+    const double one = 1.0;    // 0x3FF00000 00000000, tells the high word apart
+    const unsigned char *b = (const unsigned char *)v;
+
+    if (((const unsigned char *)&one)[0] == 0x3F) {
+        return ((unsigned long)b[0] << 24) | ((unsigned long)b[1] << 16) | ((unsigned long)b[2] << 8) | b[3];
+    }
+    return ((unsigned long)b[7] << 24) | ((unsigned long)b[6] << 16) | ((unsigned long)b[5] << 8) | b[4];
+}
+
+size_t contract_find_out_of_range(const int *v, size_t n, int min, int max) {
+    size_t i;
+
+    for (i = 0; i < n; i++) {
+        if (v[i] < min || v[i] > max) return i;
+    }
+    return n;
+}
+
+size_t contract_find_null(const void *const *v, size_t n) {
+    size_t i;
+
+    for (i = 0; i < n; i++) {
+        if (v[i] == NULL) return i;
+    }
+    return n;
+}
+
+size_t contract_find_nonfinite(const float *v, size_t n) {
+    size_t i;
+
+    for (i = 0; i < n; i++) {
+        if ((contract_float_bits(&v[i]) & CONTRACT_FLOAT_EXP) == CONTRACT_FLOAT_EXP) return i;
+    }
+    return n;
+}
+
+size_t contract_find_nonfinite_double(const double *v, size_t n) {
+    size_t i;
+
+    for (i = 0; i < n; i++) {
+        if ((contract_double_hi(&v[i]) & CONTRACT_DOUBLE_EXP_HI) == CONTRACT_DOUBLE_EXP_HI) return i;
+    }
+    return n;
+}
+
+#if CONTRACT_SIMD_AVX2
+static int contract_have_avx2(void) {
+    static int have = -1;
+
+    if (have < 0) have = __builtin_cpu_supports("avx2") ? 1 : 0;
+    return have;
+}
+
+__attribute__((target("avx2")))
+static size_t contract_in_range_avx2(const int *v, size_t n, int min, int max) {
+    const __m256i lo = _mm256_set1_epi32(min);
+    const __m256i hi = _mm256_set1_epi32(max);
+    __m256i bad, x;
+    size_t i = 0, j;
+
+    for (; i + CONTRACT_ARRAY_BLOCK <= n; i += CONTRACT_ARRAY_BLOCK) {
+        bad = _mm256_setzero_si256();
+        for (j = 0; j < CONTRACT_ARRAY_BLOCK; j += 8) {
+            x = _mm256_loadu_si256((const __m256i *)(v + i + j));
+            bad = _mm256_or_si256(bad, _mm256_or_si256(_mm256_cmpgt_epi32(lo, x), _mm256_cmpgt_epi32(x, hi)));
+        }
+        if (!_mm256_testz_si256(bad, bad)) return i;
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+static size_t contract_nonnull_avx2(const void *const *v, size_t n) {
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i bad;
+    size_t i = 0, j;
+
+    for (; i + CONTRACT_ARRAY_BLOCK <= n; i += CONTRACT_ARRAY_BLOCK) {
+        bad = zero;
+        for (j = 0; j < CONTRACT_ARRAY_BLOCK; j += 32 / sizeof(void *)) {
+            __m256i x = _mm256_loadu_si256((const __m256i *)(v + i + j));
+            bad = _mm256_or_si256(bad, sizeof(void *) == 8 ? _mm256_cmpeq_epi64(x, zero) : _mm256_cmpeq_epi32(x, zero));
+        }
+        if (!_mm256_testz_si256(bad, bad)) return i;
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+static size_t contract_finite_avx2(const float *v, size_t n) {
+    const __m256i exp = _mm256_set1_epi32((int)CONTRACT_FLOAT_EXP);
+    __m256i bad, x;
+    size_t i = 0, j;
+
+    for (; i + CONTRACT_ARRAY_BLOCK <= n; i += CONTRACT_ARRAY_BLOCK) {
+        bad = _mm256_setzero_si256();
+        for (j = 0; j < CONTRACT_ARRAY_BLOCK; j += 8) {
+            x = _mm256_loadu_si256((const __m256i *)(v + i + j));
+            bad = _mm256_or_si256(bad, _mm256_cmpeq_epi32(_mm256_and_si256(x, exp), exp));
+        }
+        if (!_mm256_testz_si256(bad, bad)) return i;
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+static size_t contract_finite_double_avx2(const double *v, size_t n) {
+    const __m256i exp = _mm256_set1_epi64x((long long)0x7FF0000000000000ULL);
+    __m256i bad, x;
+    size_t i = 0, j;
+
+    for (; i + CONTRACT_ARRAY_BLOCK <= n; i += CONTRACT_ARRAY_BLOCK) {
+        bad = _mm256_setzero_si256();
+        for (j = 0; j < CONTRACT_ARRAY_BLOCK; j += 4) {
+            x = _mm256_loadu_si256((const __m256i *)(v + i + j));
+            bad = _mm256_or_si256(bad, _mm256_cmpeq_epi64(_mm256_and_si256(x, exp), exp));
+        }
+        if (!_mm256_testz_si256(bad, bad)) return i;
+    }
+    return i;
+}
+#endif
+
+/*
+ * Vector prefixes, each returns the index of the first block holding a failure, or where the vector
+ * part stopped, the caller finishes from there with the scalar search.
+ */
+static size_t contract_in_range_simd(const int *v, size_t n, int min, int max) {
+#if CONTRACT_SIMD_SSE2
+    const __m128i lo = _mm_set1_epi32(min);
+    const __m128i hi = _mm_set1_epi32(max);
+    __m128i bad, x;
+    size_t i = 0, j;
+
+#if CONTRACT_SIMD_AVX2
+    if (contract_have_avx2()) return contract_in_range_avx2(v, n, min, max);
+#endif
+    for (; i + CONTRACT_ARRAY_BLOCK <= n; i += CONTRACT_ARRAY_BLOCK) {
+        bad = _mm_setzero_si128();
+        for (j = 0; j < CONTRACT_ARRAY_BLOCK; j += 4) {
+            x = _mm_loadu_si128((const __m128i *)(v + i + j));
+            bad = _mm_or_si128(bad, _mm_or_si128(_mm_cmplt_epi32(x, lo), _mm_cmpgt_epi32(x, hi)));
+        }
+        if (_mm_movemask_epi8(bad)) return i;
+    }
+    return i;
+#elif CONTRACT_SIMD_NEON
+    const int32x4_t lo = vdupq_n_s32(min);
+    const int32x4_t hi = vdupq_n_s32(max);
+    uint32x4_t bad;
+    int32x4_t x;
+    size_t i = 0, j;
+
+    for (; i + CONTRACT_ARRAY_BLOCK <= n; i += CONTRACT_ARRAY_BLOCK) {
+        bad = vdupq_n_u32(0);
+        for (j = 0; j < CONTRACT_ARRAY_BLOCK; j += 4) {
+            x = vld1q_s32(v + i + j);
+            bad = vorrq_u32(bad, vorrq_u32(vcltq_s32(x, lo), vcgtq_s32(x, hi)));
+        }
+        if (vmaxvq_u32(bad)) return i;
+    }
+    return i;
+#else
+    unsigned bad;
+    size_t i = 0, j;
+
+    for (; i + CONTRACT_ARRAY_BLOCK <= n; i += CONTRACT_ARRAY_BLOCK) {
+        bad = 0;
+        for (j = 0; j < CONTRACT_ARRAY_BLOCK; j++) bad |= (unsigned)(v[i + j] < min) | (unsigned)(v[i + j] > max);
+        if (bad) return i;
+    }
+    return i;
+#endif
+}
+
+static size_t contract_nonnull_simd(const void *const *v, size_t n) {
+#if CONTRACT_SIMD_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    __m128i bad, x, eq;
+    size_t i = 0, j;
+
+#if CONTRACT_SIMD_AVX2
+    if (contract_have_avx2()) return contract_nonnull_avx2(v, n);
+#endif
+    for (; i + CONTRACT_ARRAY_BLOCK <= n; i += CONTRACT_ARRAY_BLOCK) {
+        bad = zero;
+        for (j = 0; j < CONTRACT_ARRAY_BLOCK; j += 16 / sizeof(void *)) {
+            x = _mm_loadu_si128((const __m128i *)(v + i + j));
+            eq = _mm_cmpeq_epi32(x, zero);
+            // a 64 bit pointer is NULL when both of its 32 bit halves are
+            if (sizeof(void *) == 8) eq = _mm_and_si128(eq, _mm_shuffle_epi32(eq, _MM_SHUFFLE(2, 3, 0, 1)));
+            bad = _mm_or_si128(bad, eq);
+        }
+        if (_mm_movemask_epi8(bad)) return i;
+    }
+    return i;
+#elif CONTRACT_SIMD_NEON
+    uint64x2_t bad;
+    size_t i = 0, j;
+
+    for (; i + CONTRACT_ARRAY_BLOCK <= n; i += CONTRACT_ARRAY_BLOCK) {
+        bad = vdupq_n_u64(0);
+        for (j = 0; j < CONTRACT_ARRAY_BLOCK; j += 2) {
+            bad = vorrq_u64(bad, vceqzq_u64(vld1q_u64((const uint64_t *)(v + i + j))));
+        }
+        if (vmaxvq_u32(vreinterpretq_u32_u64(bad))) return i;
+    }
+    return i;
+#else
+    unsigned bad;
+    size_t i = 0, j;
+
+    for (; i + CONTRACT_ARRAY_BLOCK <= n; i += CONTRACT_ARRAY_BLOCK) {
+        bad = 0;
+        for (j = 0; j < CONTRACT_ARRAY_BLOCK; j++) bad |= (unsigned)(v[i + j] == NULL);
+        if (bad) return i;
+    }
+    return i;
+#endif
+}
+
+static size_t contract_finite_simd(const float *v, size_t n) {
+#if CONTRACT_SIMD_SSE2
+    const __m128i exp = _mm_set1_epi32((int)CONTRACT_FLOAT_EXP);
+    __m128i bad, x;
+    size_t i = 0, j;
+
+#if CONTRACT_SIMD_AVX2
+    if (contract_have_avx2()) return contract_finite_avx2(v, n);
+#endif
+    for (; i + CONTRACT_ARRAY_BLOCK <= n; i += CONTRACT_ARRAY_BLOCK) {
+        bad = _mm_setzero_si128();
+        for (j = 0; j < CONTRACT_ARRAY_BLOCK; j += 4) {
+            x = _mm_loadu_si128((const __m128i *)(v + i + j));
+            bad = _mm_or_si128(bad, _mm_cmpeq_epi32(_mm_and_si128(x, exp), exp));
+        }
+        if (_mm_movemask_epi8(bad)) return i;
+    }
+    return i;
+#elif CONTRACT_SIMD_NEON
+    const uint32x4_t exp = vdupq_n_u32(CONTRACT_FLOAT_EXP);
+    uint32x4_t bad, x;
+    size_t i = 0, j;
+
+    for (; i + CONTRACT_ARRAY_BLOCK <= n; i += CONTRACT_ARRAY_BLOCK) {
+        bad = vdupq_n_u32(0);
+        for (j = 0; j < CONTRACT_ARRAY_BLOCK; j += 4) {
+            x = vreinterpretq_u32_f32(vld1q_f32(v + i + j));
+            bad = vorrq_u32(bad, vceqq_u32(vandq_u32(x, exp), exp));
+        }
+        if (vmaxvq_u32(bad)) return i;
+    }
+    return i;
+#else
+    unsigned long bad;
+    size_t i = 0, j;
+
+    for (; i + CONTRACT_ARRAY_BLOCK <= n; i += CONTRACT_ARRAY_BLOCK) {
+        bad = 0;
+        for (j = 0; j < CONTRACT_ARRAY_BLOCK; j++) {
+            bad |= (unsigned long)((contract_float_bits(&v[i + j]) & CONTRACT_FLOAT_EXP) == CONTRACT_FLOAT_EXP);
+        }
+        if (bad) return i;
+    }
+    return i;
+#endif
+}
+
+static size_t contract_finite_double_simd(const double *v, size_t n) {
+#if CONTRACT_SIMD_SSE2
+    // compare the high word of each double only, the low lanes are made never to match
+    const __m128i mask = _mm_set_epi32((int)CONTRACT_DOUBLE_EXP_HI, 0, (int)CONTRACT_DOUBLE_EXP_HI, 0);
+    const __m128i exp = _mm_set_epi32((int)CONTRACT_DOUBLE_EXP_HI, -1, (int)CONTRACT_DOUBLE_EXP_HI, -1);
+    __m128i bad, x;
+    size_t i = 0, j;
+
+#if CONTRACT_SIMD_AVX2
+    if (contract_have_avx2()) return contract_finite_double_avx2(v, n);
+#endif
+    for (; i + CONTRACT_ARRAY_BLOCK <= n; i += CONTRACT_ARRAY_BLOCK) {
+        bad = _mm_setzero_si128();
+        for (j = 0; j < CONTRACT_ARRAY_BLOCK; j += 2) {
+            x = _mm_loadu_si128((const __m128i *)(v + i + j));
+            bad = _mm_or_si128(bad, _mm_cmpeq_epi32(_mm_and_si128(x, mask), exp));
+        }
+        if (_mm_movemask_epi8(bad)) return i;
+    }
+    return i;
+#elif CONTRACT_SIMD_NEON
+    const uint64x2_t exp = vdupq_n_u64(0x7FF0000000000000ULL);
+    uint64x2_t bad, x;
+    size_t i = 0, j;
+
+    for (; i + CONTRACT_ARRAY_BLOCK <= n; i += CONTRACT_ARRAY_BLOCK) {
+        bad = vdupq_n_u64(0);
+        for (j = 0; j < CONTRACT_ARRAY_BLOCK; j += 2) {
+            x = vreinterpretq_u64_f64(vld1q_f64(v + i + j));
+            bad = vorrq_u64(bad, vceqq_u64(vandq_u64(x, exp), exp));
+        }
+        if (vmaxvq_u32(vreinterpretq_u32_u64(bad))) return i;
+    }
+    return i;
+#else
+    unsigned long bad;
+    size_t i = 0, j;
+
+    for (; i + CONTRACT_ARRAY_BLOCK <= n; i += CONTRACT_ARRAY_BLOCK) {
+        bad = 0;
+        for (j = 0; j < CONTRACT_ARRAY_BLOCK; j++) {
+            bad |= (unsigned long)((contract_double_hi(&v[i + j]) & CONTRACT_DOUBLE_EXP_HI) == CONTRACT_DOUBLE_EXP_HI);
+        }
+        if (bad) return i;
+    }
+    return i;
+#endif
+}
+
+int contract_all_in_range(const int *v, size_t n, int min, int max) {
+    size_t i = contract_in_range_simd(v, n, min, max);
+    return contract_find_out_of_range(v + i, n - i, min, max) == n - i;
+}
+
+int contract_all_nonnull(const void *const *v, size_t n) {
+    size_t i = contract_nonnull_simd(v, n);
+    return contract_find_null(v + i, n - i) == n - i;
+}
+
+int contract_all_finite(const float *v, size_t n) {
+    size_t i = contract_finite_simd(v, n);
+    return contract_find_nonfinite(v + i, n - i) == n - i;
+}
+
+int contract_all_finite_double(const double *v, size_t n) {
+    size_t i = contract_finite_double_simd(v, n);
+    return contract_find_nonfinite_double(v + i, n - i) == n - i;
+}
+
+int _contract_all_in_range(const int *v, size_t n, int min, int max) {
+    size_t i = contract_in_range_simd(v, n, min, max);
+    size_t bad = i + contract_find_out_of_range(v + i, n - i, min, max);
+
+    if (CONTRACT_LIKELY(bad == n)) return 1;
+    _contract_set_index((long)bad);
+    return 0;
+}
+
+int _contract_all_nonnull(const void *const *v, size_t n) {
+    size_t i = contract_nonnull_simd(v, n);
+    size_t bad = i + contract_find_null(v + i, n - i);
+
+    if (CONTRACT_LIKELY(bad == n)) return 1;
+    _contract_set_index((long)bad);
+    return 0;
+}
+
+int _contract_all_finite(const float *v, size_t n) {
+    size_t i = contract_finite_simd(v, n);
+    size_t bad = i + contract_find_nonfinite(v + i, n - i);
+
+    if (CONTRACT_LIKELY(bad == n)) return 1;
+    _contract_set_index((long)bad);
+    return 0;
+}
+
+int _contract_all_finite_double(const double *v, size_t n) {
+    size_t i = contract_finite_double_simd(v, n);
+    size_t bad = i + contract_find_nonfinite_double(v + i, n - i);
+
+    if (CONTRACT_LIKELY(bad == n)) return 1;
+    _contract_set_index((long)bad);
+    return 0;
+}
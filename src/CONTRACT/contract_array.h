@@ -0,0 +1,61 @@
+/**
+ * @file contract_array.h
+ * @brief Array-level contracts checked by SIMD kernels, one branch per buffer instead of one per element
+ * @version 0.1.4
+ * @license MIT
+ * @author Jeremy Thornton
+ */
+#ifndef CONTRACT_ARRAY_H
+#define CONTRACT_ARRAY_H
+
+#include "contract.h"
+
+/**
+ * @brief Whole-buffer predicates, 1 if every element passes
+ *
+ * The kernels OR the per element failures of a block of SIMD lanes together and test the block once,
+ * AVX2 (selected at run time) or SSE2 on x86, NEON on AArch64, a branch-free scalar loop elsewhere.
+ * Only a failing buffer is scanned again for its first offending element.
+ *
+ * ensure_all_finite() tests the exponent bits, so it also holds under -ffast-math.
+ *
+ * @param v Array of n elements, may be NULL when n is 0
+ * @param n Number of elements
+ */
+int contract_all_in_range(const int *v, size_t n, int min, int max);
+int contract_all_nonnull(const void *const *v, size_t n);
+int contract_all_finite(const float *v, size_t n);
+int contract_all_finite_double(const double *v, size_t n);
+
+/**
+ * @brief First offending element, scalar, for reporting
+ *
+ * @return Index of the first element failing the predicate, n if there is none
+ */
+size_t contract_find_out_of_range(const int *v, size_t n, int min, int max);
+size_t contract_find_null(const void *const *v, size_t n);
+size_t contract_find_nonfinite(const float *v, size_t n);
+size_t contract_find_nonfinite_double(const double *v, size_t n);
+
+/**
+ * @brief Forms of the predicates used by the contracts, a failure also records the offending index
+ *
+ * The index is handed to the following _contract_fail(), see contract_failed_index().
+ */
+int _contract_all_in_range(const int *v, size_t n, int min, int max);
+int _contract_all_nonnull(const void *const *v, size_t n);
+int _contract_all_finite(const float *v, size_t n);
+int _contract_all_finite_double(const double *v, size_t n);
+
+// Array contracts, the report ends in " (index N)" naming the first offending element
+#define require_all_in_range(ptr, n, min, max, msg) _CONTRACT_REQUIRE_MATH(_contract_all_in_range(ptr, n, min, max), msg, POSIX_ERANGE)  /// @example require_all_in_range(samples, count, -32768, 32767, "Sample out of 16 bit range");
+#define require_all_nonnull(ptrs, n, msg) _CONTRACT_REQUIRE_MEMORY(_contract_all_nonnull((const void *const *)(ptrs), n), msg, POSIX_EFAULT)  /// @example require_all_nonnull(argv, argc, "NULL argument");
+#define ensure_all_finite(floats, n, msg) _CONTRACT_ENSURE_MATH(_contract_all_finite(floats, n), msg, POSIX_EDOM)  /// @example ensure_all_finite(weights, count, "Weights diverged");
+#define ensure_all_finite_double(doubles, n, msg) _CONTRACT_ENSURE_MATH(_contract_all_finite_double(doubles, n), msg, POSIX_EDOM)  /// @example ensure_all_finite_double(x, dim, "Solver produced NaN");
+
+#define try_require_all_in_range(ptr, n, min, max, msg) _CONTRACT_TRY_REQUIRE_MATH(_contract_all_in_range(ptr, n, min, max), msg, POSIX_ERANGE)
+#define try_require_all_nonnull(ptrs, n, msg) _CONTRACT_TRY_REQUIRE_MEMORY(_contract_all_nonnull((const void *const *)(ptrs), n), msg, POSIX_EFAULT)
+#define try_ensure_all_finite(floats, n, msg) _CONTRACT_TRY_ENSURE_MATH(_contract_all_finite(floats, n), msg, POSIX_EDOM)
+#define try_ensure_all_finite_double(doubles, n, msg) _CONTRACT_TRY_ENSURE_MATH(_contract_all_finite_double(doubles, n), msg, POSIX_EDOM)
+
+#endif
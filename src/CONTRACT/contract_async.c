@@ -0,0 +1,179 @@
+#define _POSIX_C_SOURCE 200112L   // nanosleep, pthreads
+
+#include "contract_async.h"
+#include "contract_atomic.h"
+#include "contract_stats.h"
+#include <string.h>
+
+#if CONTRACT_HAVE_THREADS
+#include <pthread.h>
+#endif
+
+#define CONTRACT_ASYNC_MASK (CONTRACT_ASYNC_CAPACITY - 1)
+
+typedef char contract_async_capacity_is_power_of_2[(CONTRACT_ASYNC_CAPACITY & CONTRACT_ASYNC_MASK) == 0 ? 1 : -1];
+
+/*
+ * Bounded MPSC queue after D. Vyukov. Each slot carries a sequence number telling producers and
+ * the consumer whose turn it is: slot i is free for the producer at position pos when seq == pos,
+ * and holds the record for the consumer at pos when seq == pos + 1.
+ * The stored value is seq - i so that the zero initialised ring starts out with every slot free.
+ */
+typedef struct {
+    unsigned long seq;
+    contract_record_t rec;
+} contract_slot_t;
+
+static contract_slot_t ring[CONTRACT_ASYNC_CAPACITY];
+static unsigned long ring_head = 0;     // next position to produce, shared by producers
+static unsigned long ring_tail = 0;     // next position to consume, owned by the draining thread
+static unsigned long ring_dropped = 0;
+static int ring_draining = 0;
+
+static unsigned long contract_thread_id(void) {
+#if CONTRACT_HAVE_THREADS
+    return (unsigned long)pthread_self();
+#else
+    return 0;
+#endif
+}
+
+int contract_async_push(const contract_site_t *site, posix_error_t err) {
+    unsigned long pos = CONTRACT_ATOMIC_LOAD(&ring_head);
+    contract_slot_t *slot;
+    long diff;
+
+    for (;;) {
+        slot = &ring[pos & CONTRACT_ASYNC_MASK];
+        diff = (long)(CONTRACT_ATOMIC_LOAD(&slot->seq) + (pos & CONTRACT_ASYNC_MASK) - pos);
+        if (diff == 0) {
+            if (CONTRACT_ATOMIC_CAS(&ring_head, &pos, pos + 1)) break;
+        } else if (diff < 0) {
+            CONTRACT_ATOMIC_FETCH_ADD(&ring_dropped, 1);  // full, never block the failing thread
+            return 0;
+        } else {
+            pos = CONTRACT_ATOMIC_LOAD(&ring_head);
+        }
+    }
+
+    slot->rec.site = *site;
+    slot->rec.err = err;
+    slot->rec.stamp = time(NULL);
+    slot->rec.thread = contract_thread_id();
+    CONTRACT_ATOMIC_STORE(&slot->seq, pos + 1 - (pos & CONTRACT_ASYNC_MASK));
+    return 1;
+}
+
+unsigned contract_async_drain(void (*fn)(const contract_record_t *rec, void *ctx), void *ctx) {
+    unsigned count = 0;
+    int idle = 0;
+    contract_record_t rec;
+    contract_slot_t *slot;
+    unsigned long pos;
+
+    // strong, a spurious failure would skip the drain, the one before abort() included
+    if (!CONTRACT_ATOMIC_CAS_STRONG(&ring_draining, &idle, 1)) return 0;
+
+    for (pos = ring_tail; ; pos++) {
+        slot = &ring[pos & CONTRACT_ASYNC_MASK];
+        if (CONTRACT_ATOMIC_LOAD(&slot->seq) + (pos & CONTRACT_ASYNC_MASK) != pos + 1) break;
+        rec = slot->rec;
+        CONTRACT_ATOMIC_STORE(&slot->seq, pos + CONTRACT_ASYNC_CAPACITY - (pos & CONTRACT_ASYNC_MASK));
+        fn(&rec, ctx);
+        count++;
+    }
+    ring_tail = pos;
+
+    CONTRACT_ATOMIC_STORE(&ring_draining, 0);
+    return count;
+}
+
+typedef struct {
+    char buf[CONTRACT_LINE_MAX * 4];
+    size_t len;
+} contract_batch_t;
+
+static void contract_batch_line(const contract_record_t *rec, void *ctx) {
+    contract_batch_t *batch = (contract_batch_t *)ctx;
+
+    if (batch->len + CONTRACT_LINE_MAX > sizeof(batch->buf)) {
+        contract_write(batch->buf, batch->len);
+        batch->len = 0;
+    }
+    batch->len += contract_format(batch->buf + batch->len, CONTRACT_LINE_MAX, &rec->site, rec->err, rec->stamp);
+}
+
+unsigned contract_flush(void) {
+    contract_batch_t batch;
+    unsigned count;
+
+    batch.len = 0;
+    count = contract_async_drain(contract_batch_line, &batch);
+    if (batch.len) contract_write(batch.buf, batch.len);
+    return count;
+}
+
+unsigned long contract_async_dropped(void) {
+    return CONTRACT_ATOMIC_LOAD(&ring_dropped);
+}
+
+posix_error_t contract_handler_async(const contract_site_t *site) {
+    unsigned long suppressed;
+
+    if (contract_should_report(site, &suppressed)) contract_async_push(site, site->err);
+    return site->err;
+}
+
+#if CONTRACT_HAVE_THREADS
+
+static pthread_t drain_thread;
+static int drain_running = 0;
+static int drain_stop = 0;
+static unsigned drain_period_ms = 0;
+
+static void *contract_drain_main(void *arg) {
+    struct timespec period;
+
+    (void)arg;
+    period.tv_sec = drain_period_ms / 1000;
+    period.tv_nsec = (long)(drain_period_ms % 1000) * 1000000L;
+    while (!CONTRACT_ATOMIC_LOAD(&drain_stop)) {
+        contract_flush();
+        nanosleep(&period, NULL);
+    }
+    return NULL;
+}
+
+posix_error_t contract_async_start(unsigned period_ms) {
+    int rc;
+
+    if (drain_running) return POSIX_EALREADY;
+    drain_period_ms = period_ms;
+    CONTRACT_ATOMIC_STORE(&drain_stop, 0);
+    rc = pthread_create(&drain_thread, NULL, contract_drain_main, NULL);
+    if (rc != 0) return (posix_error_t)rc;
+    drain_running = 1;
+    return POSIX_SUCCESS;
+}
+
+void contract_async_stop(void) {
+    if (drain_running) {
+        CONTRACT_ATOMIC_STORE(&drain_stop, 1);
+        pthread_join(drain_thread, NULL);
+        drain_running = 0;
+    }
+    contract_flush();
+}
+
+#else
+
+posix_error_t contract_async_start(unsigned period_ms) {
+    (void)period_ms;
+    return POSIX_ENOTSUP;
+}
+
+void contract_async_stop(void) {
+    contract_flush();
+}
+
+#endif
@@ -0,0 +1,91 @@
+/**
+ * @file contract_async.h
+ * @brief Asynchronous contract violation logging through a lock-free ring buffer
+ * @version 0.1.4
+ * @license MIT
+ * @author Jeremy Thornton
+ */
+#ifndef CONTRACT_ASYNC_H
+#define CONTRACT_ASYNC_H
+
+#include "contract.h"
+
+/**
+ * @brief Number of violation records the ring buffer holds, must be a power of 2
+ *
+ * A failing site never waits for room, when the ring is full the record is dropped and counted,
+ * see contract_async_dropped().
+ */
+#ifndef CONTRACT_ASYNC_CAPACITY
+#define CONTRACT_ASYNC_CAPACITY 64
+#endif
+
+/**
+ * @brief Fixed size binary record of one contract violation
+ *
+ * Pushed by the failing thread without formatting, locks or allocation. Turning it into text is
+ * left to whoever drains the ring, see contract_flush(). The descriptor is copied, those reported through
+ * _contract_fail_at() live on the failing thread's stack, its strings are the static ones of the site.
+ */
+typedef struct {
+    contract_site_t site;           /**< Copy of the descriptor of the contract that failed */
+    posix_error_t err;              /**< errno recorded for the violation */
+    time_t stamp;                   /**< Coarse, one second, time of the violation */
+    unsigned long thread;           /**< Identifier of the failing thread, 0 without threads */
+} contract_record_t;
+
+/**
+ * @brief Queues a violation record, safe to call from any number of threads at once
+ *
+ * @param site Descriptor of the contract that failed, copied into the record
+ * @param err errno recorded for the violation
+ * @return 1 if queued, 0 if the ring was full and the record was dropped
+ */
+int contract_async_push(const contract_site_t *site, posix_error_t err);
+
+/**
+ * @brief Removes every queued record, oldest first, passing each to fn
+ *
+ * Only one drain runs at a time, a concurrent call returns 0 immediately rather than wait.
+ *
+ * @param fn Callback invoked with each record
+ * @param ctx Caller context handed through to fn
+ * @return Number of records drained
+ */
+unsigned contract_async_drain(void (*fn)(const contract_record_t *rec, void *ctx), void *ctx);
+
+/**
+ * @brief Formats every queued record in the standard report format and writes them to stderr in batches
+ *
+ * @return Number of records written
+ */
+unsigned contract_flush(void);
+
+/**
+ * @brief Number of records dropped because the ring buffer was full
+ */
+unsigned long contract_async_dropped(void);
+
+/**
+ * @brief Log-and-continue violation handler that queues the record instead of reporting it inline
+ *
+ * Install with contract_set_handler(contract_handler_async) in a CONTRACT_RECOVERABLE build and drain
+ * with contract_flush() or the background thread of contract_async_start().
+ */
+posix_error_t contract_handler_async(const contract_site_t *site);
+
+/**
+ * @brief Starts a background thread calling contract_flush() every period_ms milliseconds
+ *
+ * @param period_ms Drain period in milliseconds
+ * @return POSIX_SUCCESS, POSIX_EALREADY if running, POSIX_ENOTSUP without CONTRACT_HAVE_THREADS,
+ *         or the error code of the failed thread creation
+ */
+posix_error_t contract_async_start(unsigned period_ms);
+
+/**
+ * @brief Stops the background drain thread, if any, and flushes what is left in the ring
+ */
+void contract_async_stop(void);
+
+#endif
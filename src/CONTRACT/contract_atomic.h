@@ -0,0 +1,49 @@
+/**
+ * @file contract_atomic.h
+ * @brief Minimal atomic operations for the contract runtime's shared counters and queues
+ * @version 0.1.4
+ * @license MIT
+ * @author Jeremy Thornton
+ */
+#ifndef CONTRACT_ATOMIC_H
+#define CONTRACT_ATOMIC_H
+
+/**
+ * @brief Atomic load, store, fetch-add, exchange and compare-exchange on integer and pointer objects
+ *
+ * GCC and Clang map onto the __atomic builtins. Other compilers, Open Watcom for DOS in particular,
+ * are taken to be single threaded and use plain memory accesses, which is sufficient as long as the
+ * contract runtime is not also entered from an interrupt handler.
+ *
+ * The single threaded CONTRACT_ATOMIC_EXCHANGE is only provided for unsigned long objects.
+ * CONTRACT_ATOMIC_CAS(p, expected, desired) stores desired in *p if *p equals *expected and yields 1,
+ * otherwise it copies *p into *expected and yields 0. It may fail spuriously, so use it in a loop.
+ * CONTRACT_ATOMIC_CAS_STRONG fails only when *p differs, for a single try that must not be lost.
+ */
+#if defined(__GNUC__) || defined(__clang__)
+#define CONTRACT_ATOMIC_LOAD(p)                 __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define CONTRACT_ATOMIC_STORE(p, v)             __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define CONTRACT_ATOMIC_FETCH_ADD(p, v)         __atomic_fetch_add((p), (v), __ATOMIC_RELAXED)
+#define CONTRACT_ATOMIC_EXCHANGE(p, v)          __atomic_exchange_n((p), (v), __ATOMIC_ACQ_REL)
+#define CONTRACT_ATOMIC_CAS(p, expected, desired) \
+    __atomic_compare_exchange_n((p), (expected), (desired), 1, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+#define CONTRACT_ATOMIC_CAS_STRONG(p, expected, desired) \
+    __atomic_compare_exchange_n((p), (expected), (desired), 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+#else
+#define CONTRACT_ATOMIC_LOAD(p)                 (*(p))
+#define CONTRACT_ATOMIC_STORE(p, v)             (*(p) = (v))
+#define CONTRACT_ATOMIC_FETCH_ADD(p, v)         ((*(p) += (v)) - (v))
+#define CONTRACT_ATOMIC_EXCHANGE(p, v)          _contract_exchange_ul((p), (v))
+
+static unsigned long _contract_exchange_ul(unsigned long *p, unsigned long v) {
+    unsigned long old = *p;
+    *p = v;
+    return old;
+}
+
+#define CONTRACT_ATOMIC_CAS(p, expected, desired) \
+    ((*(p) == *(expected)) ? (*(p) = (desired), 1) : (*(expected) = *(p), 0))
+#define CONTRACT_ATOMIC_CAS_STRONG(p, expected, desired) CONTRACT_ATOMIC_CAS(p, expected, desired)
+#endif
+
+#endif
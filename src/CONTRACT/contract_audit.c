@@ -0,0 +1,171 @@
+#define _XOPEN_SOURCE 600   // clock_gettime, nanosleep, setpriority, pthreads
+
+#include "contract_audit.h"
+#include "contract_atomic.h"
+
+#if CONTRACT_HAVE_THREADS
+#include <pthread.h>
+#include <sys/resource.h>
+
+static pthread_mutex_t audit_lock = PTHREAD_MUTEX_INITIALIZER;
+#define AUDIT_LOCK() pthread_mutex_lock(&audit_lock)
+#define AUDIT_UNLOCK() pthread_mutex_unlock(&audit_lock)
+#else
+#define AUDIT_LOCK() ((void)0)
+#define AUDIT_UNLOCK() ((void)0)
+#endif
+
+static contract_audit_t *audits = NULL;
+static contract_audit_t *audit_next = NULL;     // next to run, NULL starts a new pass
+
+void _contract_audit_add(contract_audit_t *a, const contract_site_t *site, contract_audit_fn check, void *ctx) {
+    a->site = site;
+    a->check = check;
+    a->ctx = ctx;
+
+    AUDIT_LOCK();
+    a->next = audits;
+    audits = a;
+    AUDIT_UNLOCK();
+}
+
+void contract_audit_remove(contract_audit_t *a) {
+    contract_audit_t **p;
+
+    AUDIT_LOCK();
+    for (p = &audits; *p; p = &(*p)->next) {
+        if (*p == a) {
+            *p = a->next;
+            break;
+        }
+    }
+    if (audit_next == a) audit_next = a->next;
+    a->next = NULL;
+    AUDIT_UNLOCK();
+}
+
+/*
+ * Runs the next audit, reporting a violation once the lock is released. Returns 0 if there is none,
+ * otherwise 1, or 2 when the audit run was the last of a pass.
+ */
+static int contract_audit_step(void) {
+    const contract_site_t *failed = NULL;
+    contract_audit_t *a;
+    int step;
+
+    AUDIT_LOCK();
+    a = audit_next ? audit_next : audits;
+    if (!a) {
+        AUDIT_UNLOCK();
+        return 0;
+    }
+    if (!a->check(a->ctx)) failed = a->site;
+    audit_next = a->next;
+    step = a->next ? 1 : 2;     // decided under the lock, audit_next is shared with other callers
+    AUDIT_UNLOCK();
+
+    if (CONTRACT_UNLIKELY(failed != NULL)) (void)_contract_fail(failed);
+    return step;
+}
+
+unsigned contract_audit_run(unsigned budget_ms) {
+    clock_t start = clock();
+    clock_t budget = (clock_t)((double)budget_ms * CLOCKS_PER_SEC / 1000);
+    unsigned count = 0;
+    int step;
+
+    while ((step = contract_audit_step()) != 0) {
+        count++;
+        if (step == 2 || clock() - start >= budget) break;
+    }
+    return count;
+}
+
+#if CONTRACT_HAVE_THREADS
+
+static pthread_t audit_thread;
+static int audit_running = 0;
+static int audit_stop = 0;
+static unsigned audit_period_ms = 0;
+static unsigned audit_budget = 100;
+
+// Processor time of the audit thread where the system measures it, else wall time as an upper bound
+static double contract_audit_clock(void) {
+    struct timespec now;
+
+#if defined(_POSIX_THREAD_CPUTIME) && _POSIX_THREAD_CPUTIME >= 0
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now) == 0) return now.tv_sec + now.tv_nsec * 1e-9;
+#endif
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+// Sleeps in slices short enough for contract_audit_stop() to be prompt
+static void contract_audit_sleep(double seconds) {
+    struct timespec pause;
+    double slice;
+
+    while (seconds > 0 && !CONTRACT_ATOMIC_LOAD(&audit_stop)) {
+        slice = seconds < 0.1 ? seconds : 0.1;
+        pause.tv_sec = 0;
+        pause.tv_nsec = (long)(slice * 1e9);
+        nanosleep(&pause, NULL);
+        seconds -= slice;
+    }
+}
+
+static void *contract_audit_main(void *arg) {
+    double start, spent;
+    int step;
+
+    (void)arg;
+#if defined(__linux__)
+    (void)setpriority(PRIO_PROCESS, 0, 19);     // Linux renices the calling thread alone
+#endif
+    while (!CONTRACT_ATOMIC_LOAD(&audit_stop)) {
+        start = contract_audit_clock();
+        step = contract_audit_step();
+        spent = contract_audit_clock() - start;
+
+        // idle for (100 - budget) / budget of the time just spent auditing
+        contract_audit_sleep(spent * (100 - audit_budget) / audit_budget);
+        if (step != 1) contract_audit_sleep(audit_period_ms / 1000.0);
+    }
+    return NULL;
+}
+
+posix_error_t contract_audit_start(unsigned period_ms, unsigned budget_percent) {
+    int rc;
+
+    if (audit_running) return POSIX_EALREADY;
+    if (period_ms == 0) return POSIX_EINVAL;    // the thread would never rest between passes
+    if (budget_percent < 1 || budget_percent > 100) return POSIX_EINVAL;
+    audit_period_ms = period_ms;
+    audit_budget = budget_percent;
+    CONTRACT_ATOMIC_STORE(&audit_stop, 0);
+    rc = pthread_create(&audit_thread, NULL, contract_audit_main, NULL);
+    if (rc != 0) return (posix_error_t)rc;
+    audit_running = 1;
+    return POSIX_SUCCESS;
+}
+
+void contract_audit_stop(void) {
+    if (audit_running) {
+        CONTRACT_ATOMIC_STORE(&audit_stop, 1);
+        pthread_join(audit_thread, NULL);
+        audit_running = 0;
+    }
+}
+
+#else
+
+posix_error_t contract_audit_start(unsigned period_ms, unsigned budget_percent) {
+    (void)period_ms;
+    (void)budget_percent;
+    return POSIX_ENOTSUP;
+}
+
+void contract_audit_stop(void) {
+}
+
+#endif
@@ -0,0 +1,97 @@
+/**
+ * @file contract_audit.h
+ * @brief Scheduler for audits too expensive to run inline, on a low priority thread under a CPU budget
+ * @version 0.1.4
+ * @license MIT
+ * @author Jeremy Thornton
+ */
+#ifndef CONTRACT_AUDIT_H
+#define CONTRACT_AUDIT_H
+
+#include "contract.h"
+
+/**
+ * @brief Deep check run by the scheduler, 1 if it holds
+ *
+ * Heap walks, descriptor table sweeps, fstat() probes of cached handles and the like. A check runs on
+ * the audit thread with the scheduler's lock held, so it must not add or remove audits itself.
+ */
+typedef int (*contract_audit_fn)(void *ctx);
+
+/**
+ * @brief Scheduled audit, owned by the caller
+ */
+typedef struct contract_audit {
+    const contract_site_t *site;    /**< Reported through _contract_fail() when check fails */
+    contract_audit_fn check;
+    void *ctx;
+    struct contract_audit *next;
+} contract_audit_t;
+
+/**
+ * @brief Schedules an audit, its static site descriptor is in the site table as check(ctx)
+ *
+ * Audits are CONTRACT_LEVEL_AUDIT contracts, below that level contract_audit_add() registers nothing
+ * and only type checks check(ctx).
+ *
+ * @param a Entry, must stay valid until contract_audit_remove()
+ * @param check Audit callback
+ * @param ctx Handed to check
+ * @param msg Custom error message to display if contract is violated, must be a string literal
+ */
+#if CONTRACT_LEVEL >= CONTRACT_LEVEL_AUDIT
+#define contract_audit_add(a, check, ctx, msg) \
+    do { \
+        _CONTRACT_SITE(check(ctx), msg, POSIX_EINVAL); \
+        _contract_audit_add(a, &_contract_site, check, ctx); \
+    } while (0)  /// @example contract_audit_add(&heap_audit, heap_consistent, pool, "Heap corrupt");
+#else
+#define contract_audit_add(a, check, ctx, msg) \
+    do { \
+        (void)sizeof(a); \
+        (void)sizeof(check(ctx)); \
+    } while (0)
+#endif
+
+void _contract_audit_add(contract_audit_t *a, const contract_site_t *site, contract_audit_fn check, void *ctx);
+
+/**
+ * @brief Unschedules an audit, waiting for it to finish if it is running
+ */
+void contract_audit_remove(contract_audit_t *a);
+
+/**
+ * @brief Runs the scheduled audits in turn from where the last call stopped, for builds without threads
+ *
+ * At least one audit is run, then more until budget_ms of processor time (clock()) has been used or
+ * every audit has had its turn. Violations go to the installed handler on the calling thread.
+ *
+ * @param budget_ms Processor time to spend, in milliseconds
+ * @return Number of audits run
+ */
+unsigned contract_audit_run(unsigned budget_ms);
+
+/**
+ * @brief Starts the background audit thread
+ *
+ * The thread runs at the lowest priority (nice 19 on Linux) and takes the audits in turn. After each
+ * one it sleeps long enough to keep its processor time within budget_percent of one core, and after
+ * each pass over all of them it waits period_ms. Violations go to the installed handler on the audit
+ * thread, which must therefore not longjmp().
+ *
+ * @param period_ms Pause between passes over the audits, at least 1
+ * @param budget_percent Share of one core the audits may use, 1 to 100
+ * @return POSIX_SUCCESS, POSIX_EALREADY if running, POSIX_EINVAL for a period of 0 or a budget out of range,
+ *         POSIX_ENOTSUP without CONTRACT_HAVE_THREADS or the error of pthread_create()
+ */
+posix_error_t contract_audit_start(unsigned period_ms, unsigned budget_percent);
+
+/**
+ * @brief Stops the background audit thread, after the audit it is running
+ *
+ * The thread sleeps in slices of at most 100 ms, so a long period or budget pause delays the stop by one
+ * slice at most.
+ */
+void contract_audit_stop(void);
+
+#endif
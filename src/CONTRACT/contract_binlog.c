@@ -0,0 +1,111 @@
+#include "contract_binlog.h"
+#include "contract_stats.h"
+#include <errno.h>
+
+static FILE *binlog = NULL;
+static int binlog_owned = 0;
+static time_t binlog_last = 0;
+
+static void contract_put_u32(unsigned char *p, unsigned long v) {
+    p[0] = (unsigned char)(v & 0xFF);
+    p[1] = (unsigned char)((v >> 8) & 0xFF);
+    p[2] = (unsigned char)((v >> 16) & 0xFF);
+    p[3] = (unsigned char)((v >> 24) & 0xFF);
+}
+
+posix_error_t contract_binlog_open(const char *path) {
+    FILE *fp = fopen(path, "wb");
+    posix_error_t err;
+
+    if (!fp) return errno ? (posix_error_t)errno : POSIX_EIO;
+    err = contract_binlog_attach(fp);
+    if (err != POSIX_SUCCESS) {
+        fclose(fp);
+        return err;
+    }
+    binlog_owned = 1;
+    return POSIX_SUCCESS;
+}
+
+posix_error_t contract_binlog_attach(FILE *fp) {
+    unsigned char header[8];
+
+    contract_binlog_close();
+    binlog_last = time(NULL);
+    header[0] = CONTRACT_BINLOG_MAGIC[0];
+    header[1] = CONTRACT_BINLOG_MAGIC[1];
+    header[2] = CONTRACT_BINLOG_MAGIC[2];
+    header[3] = CONTRACT_BINLOG_MAGIC[3];
+    contract_put_u32(header + 4, (unsigned long)binlog_last);
+    if (fwrite(header, 1, sizeof(header), fp) != sizeof(header)) return POSIX_EIO;
+    binlog = fp;
+    binlog_owned = 0;
+    return POSIX_SUCCESS;
+}
+
+void contract_binlog_close(void) {
+    if (!binlog) return;
+    if (binlog_owned) fclose(binlog);
+    else fflush(binlog);
+    binlog = NULL;
+    binlog_owned = 0;
+}
+
+void contract_binlog_write(const contract_site_t *site, posix_error_t err, time_t stamp) {
+    unsigned char rec[4 + 1 + 5];
+    unsigned long delta;
+    size_t len = 5;
+
+    if (!binlog) return;
+    delta = stamp > binlog_last ? (unsigned long)(stamp - binlog_last) : 0;
+    binlog_last = stamp > binlog_last ? stamp : binlog_last;
+
+    contract_put_u32(rec, contract_site_id(site));
+    rec[4] = (unsigned char)err;
+    do {
+        rec[len] = (unsigned char)(delta & 0x7F);
+        delta >>= 7;
+        if (delta) rec[len] |= 0x80;
+        len++;
+    } while (delta);
+    fwrite(rec, 1, len, binlog);
+}
+
+void contract_binlog_record(const contract_record_t *rec, void *ctx) {
+    (void)ctx;
+    contract_binlog_write(&rec->site, rec->err, rec->stamp);
+}
+
+posix_error_t contract_handler_binlog(const contract_site_t *site) {
+    unsigned long suppressed;
+
+    if (contract_should_report(site, &suppressed)) contract_binlog_write(site, site->err, time(NULL));
+    return site->err;
+}
+
+typedef struct {
+    FILE *out;
+    unsigned count;
+} contract_dump_t;
+
+static void contract_site_line(const contract_site_t *site, void *ctx) {
+    contract_dump_t *dump = (contract_dump_t *)ctx;
+    const char *p;
+
+    fprintf(dump->out, "%08lX\t%s\t%d\t%d\t%s\t", contract_site_id(site), site->file, site->line, site->err,
+        site->cond ? site->cond : "");
+    for (p = site->msg ? site->msg : ""; *p; p++) {
+        fputc(*p == '\n' || *p == '\t' ? ' ' : *p, dump->out);   // keep one site per line
+    }
+    fputc('\n', dump->out);
+    dump->count++;
+}
+
+unsigned contract_site_dump(FILE *out) {
+    contract_dump_t dump;
+
+    dump.out = out;
+    dump.count = 0;
+    contract_site_foreach(contract_site_line, &dump);
+    return dump.count;
+}
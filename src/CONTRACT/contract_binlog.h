@@ -0,0 +1,88 @@
+/**
+ * @file contract_binlog.h
+ * @brief Compact binary contract violation log, decoded offline by contract_decode
+ * @version 0.1.4
+ * @license MIT
+ * @author Jeremy Thornton
+ */
+#ifndef CONTRACT_BINLOG_H
+#define CONTRACT_BINLOG_H
+
+#include "contract.h"
+#include "contract_async.h"
+#include <stdio.h>
+
+/**
+ * @brief Binary log layout, all multi-byte fields little endian
+ *
+ * Header, once per log:
+ *     "DbC1"          4 byte magic
+ *     base time       4 bytes, seconds since the epoch when the log was opened
+ * Record, per violation:
+ *     site id         4 bytes, see contract_site_id()
+ *     errno           1 byte
+ *     delta time      1+ bytes, LEB128 seconds since the previous record (or the base time)
+ *
+ * A typical record is 6 bytes against 100+ for the text report, and costs no strftime or
+ * contract_strerror() at failure time. The text is rebuilt offline from the site table.
+ */
+#define CONTRACT_BINLOG_MAGIC "DbC1"
+
+/**
+ * @brief Starts binary logging to a newly created file
+ *
+ * @param path File to create, truncated if it exists
+ * @return POSIX_SUCCESS or the errno of the failed fopen()
+ */
+posix_error_t contract_binlog_open(const char *path);
+
+/**
+ * @brief Starts binary logging to an already open stream, e.g. fdopen(fd, "wb")
+ *
+ * @param fp Binary stream, owned by the caller and left open by contract_binlog_close()
+ * @return POSIX_SUCCESS, or POSIX_EIO if the header cannot be written
+ */
+posix_error_t contract_binlog_attach(FILE *fp);
+
+/**
+ * @brief Flushes the binary log and closes it if it was opened by contract_binlog_open()
+ */
+void contract_binlog_close(void);
+
+/**
+ * @brief Appends one violation record to the binary log, does nothing when no log is open
+ *
+ * @param site Static descriptor of the contract that failed
+ * @param err errno recorded for the violation
+ * @param stamp Time of the violation
+ */
+void contract_binlog_write(const contract_site_t *site, posix_error_t err, time_t stamp);
+
+/**
+ * @brief contract_async_drain() callback writing each record to the binary log
+ *
+ * The binary log keeps a single running timestamp so it is not safe to write from several threads at once.
+ * Threaded programs install contract_handler_async and drain with contract_async_drain(contract_binlog_record, NULL).
+ */
+void contract_binlog_record(const contract_record_t *rec, void *ctx);
+
+/**
+ * @brief Log-and-continue violation handler writing straight to the binary log, single threaded programs
+ */
+posix_error_t contract_handler_binlog(const contract_site_t *site);
+
+/**
+ * @brief Writes the site table of this binary, one tab separated line per contract site
+ *
+ * Line format: site id (8 hex digits), file, line, errno, condition, message
+ * contract_decode reads this table to turn binary log records back into the text report format.
+ * Like contract_site_foreach() it needs CONTRACT_HAVE_SITE_TABLE, so for targets without one (DOS)
+ * dump the table from a host build of the same sources, the site ids only depend on file and line.
+ * The same goes for CONTRACT_STRIP_TEXT builds, whose sites have an empty condition and message.
+ *
+ * @param out Stream to write the table to
+ * @return Number of sites written
+ */
+unsigned contract_site_dump(FILE *out);
+
+#endif
@@ -0,0 +1,381 @@
+/**
+ * @file contract_config.h
+ * @brief Compile-time configuration of contract levels and contract groups
+ * @version 0.1.4
+ * @license MIT
+ * @author Jeremy Thornton
+ */
+#ifndef CONTRACT_CONFIG_H
+#define CONTRACT_CONFIG_H
+
+/**
+ * @brief Contract levels, ordered so that each level also enables every level below it
+ *
+ * - CONTRACT_LEVEL_NONE       no contracts are compiled in
+ * - CONTRACT_LEVEL_REQUIRE    preconditions only: require, require_*
+ * - CONTRACT_LEVEL_ENSURE     adds postconditions: ensure, ensure_*
+ * - CONTRACT_LEVEL_INVARIANT  adds object invariants: invariant
+ * - CONTRACT_LEVEL_AUDIT      adds expensive checks intended for test builds: audit
+ *
+ * Select a level on the command line, e.g. -dCONTRACT_LEVEL=1 (Watcom) or -DCONTRACT_LEVEL=1.
+ * When CONTRACT_LEVEL is not set the default is CONTRACT_LEVEL_INVARIANT,
+ * or CONTRACT_LEVEL_REQUIRE when NDEBUG is defined, so release builds keep the
+ * cheap API boundary guards and drop the inner loop ensure/invariant checks.
+ */
+#define CONTRACT_LEVEL_NONE         0
+#define CONTRACT_LEVEL_REQUIRE      1
+#define CONTRACT_LEVEL_ENSURE       2
+#define CONTRACT_LEVEL_INVARIANT    3
+#define CONTRACT_LEVEL_AUDIT        4
+
+#ifndef CONTRACT_LEVEL
+#ifdef NDEBUG
+#define CONTRACT_LEVEL CONTRACT_LEVEL_REQUIRE
+#else
+#define CONTRACT_LEVEL CONTRACT_LEVEL_INVARIANT
+#endif
+#endif
+
+/**
+ * @brief Per group switches for the require_* / ensure_* specialisations
+ *
+ * Each group defaults to 1 (enabled). Defining a switch as 0 compiles the whole group out
+ * regardless of CONTRACT_LEVEL, e.g. -dCONTRACT_ENABLE_FILESYSTEM=0
+ *
+ * The groups follow the sections of contract.h:
+ * - MEMORY      Memory/Address contracts and the Memory/Validity ensure_* guards
+ * - FILESYSTEM  Filesystem contracts
+ * - NETWORK     Network contracts
+ * - PROCESS     Process/System contracts and the State Consistency ensure_* guards
+ * - MATH        Math/Domain contracts and the Mathematical ensure_* guarantees
+ * - STREAM      Stream contracts
+ *
+ * The default require, ensure, invariant and audit belong to no group and follow CONTRACT_LEVEL only.
+ */
+#ifndef CONTRACT_ENABLE_MEMORY
+#define CONTRACT_ENABLE_MEMORY 1
+#endif
+
+#ifndef CONTRACT_ENABLE_FILESYSTEM
+#define CONTRACT_ENABLE_FILESYSTEM 1
+#endif
+
+#ifndef CONTRACT_ENABLE_NETWORK
+#define CONTRACT_ENABLE_NETWORK 1
+#endif
+
+#ifndef CONTRACT_ENABLE_PROCESS
+#define CONTRACT_ENABLE_PROCESS 1
+#endif
+
+#ifndef CONTRACT_ENABLE_MATH
+#define CONTRACT_ENABLE_MATH 1
+#endif
+
+#ifndef CONTRACT_ENABLE_STREAM
+#define CONTRACT_ENABLE_STREAM 1
+#endif
+
+/**
+ * @brief Recoverable contract mode
+ *
+ * With CONTRACT_RECOVERABLE 0 (default) a violation never returns to the failing site: the installed handler
+ * may report, log or longjmp but if it returns the program is still terminated with abort(), which lets
+ * _contract_fail() stay noreturn. With CONTRACT_RECOVERABLE 1 a handler that returns resumes execution after
+ * the failed contract and the try_* forms evaluate to the site's posix_error_t, see contract_set_handler().
+ */
+#ifndef CONTRACT_RECOVERABLE
+#define CONTRACT_RECOVERABLE 0
+#endif
+
+/**
+ * @brief Per site violation counters and report rate limiting, see contract_stats.h
+ *
+ * With CONTRACT_STATS 1 (default) every contract site carries a small static counter block next to its
+ * descriptor. CONTRACT_REPORT_BURST and CONTRACT_REPORT_PERIOD are the default rate limit: the first
+ * BURST violations of a site are reported, after that at most one summary every PERIOD seconds.
+ */
+#ifndef CONTRACT_STATS
+#define CONTRACT_STATS 1
+#endif
+
+#ifndef CONTRACT_REPORT_BURST
+#define CONTRACT_REPORT_BURST 10
+#endif
+
+#ifndef CONTRACT_REPORT_PERIOD
+#define CONTRACT_REPORT_PERIOD 60
+#endif
+
+/**
+ * @brief Sampled checking of hot contracts
+ *
+ * The require_sampled() family always samples. Setting CONTRACT_SAMPLE_LEVEL also samples every plain
+ * statement contract of that level and above at 1 in CONTRACT_SAMPLE_RATE, e.g. a production build with
+ *     -dCONTRACT_LEVEL=4 -dCONTRACT_SAMPLE_LEVEL=3 -dCONTRACT_SAMPLE_RATE=64
+ * checks every require and ensure, and every 64th pass of each invariant and audit. The default,
+ * one above CONTRACT_LEVEL_AUDIT, samples nothing. The try_* forms are never sampled.
+ *
+ * CONTRACT_SAMPLE_RANDOM 0 checks each site on its first pass and then every rate-th pass of the same
+ * thread, CONTRACT_SAMPLE_RANDOM 1 checks each pass with probability 1/rate from a per thread xorshift,
+ * which cannot fall into step with a loop whose bad elements recur at the sampling period.
+ */
+#ifndef CONTRACT_SAMPLE_LEVEL
+#define CONTRACT_SAMPLE_LEVEL (CONTRACT_LEVEL_AUDIT + 1)
+#endif
+
+#ifndef CONTRACT_SAMPLE_RATE
+#define CONTRACT_SAMPLE_RATE 16
+#endif
+
+#ifndef CONTRACT_SAMPLE_RANDOM
+#define CONTRACT_SAMPLE_RANDOM 0
+#endif
+
+/**
+ * @brief Contract coverage, see contract_coverage.h
+ *
+ * CONTRACT_COVERAGE 1 is a profiled build without the timing: every site counts its evaluations, and at
+ * exit the counts of every site in the binary, those never reached included, are added into the file
+ * named by the CONTRACT_COVERAGE environment variable, else CONTRACT_COVERAGE_FILE.
+ */
+#ifndef CONTRACT_COVERAGE
+#define CONTRACT_COVERAGE 0
+#endif
+
+#ifndef CONTRACT_COVERAGE_FILE
+#define CONTRACT_COVERAGE_FILE "contract.cov"
+#endif
+
+/**
+ * @brief Contract evaluation profiler, see contract_profile.h
+ *
+ * CONTRACT_PROFILE 1 is an instrumentation build: every require/ensure/invariant/audit statement counts
+ * its evaluations and, with CONTRACT_PROFILE_CYCLES 1 (the default when profiling), also the ticks spent
+ * evaluating its condition. Off by default, a profiled check costs two tick reads and two atomic adds.
+ */
+#ifndef CONTRACT_PROFILE
+#define CONTRACT_PROFILE CONTRACT_COVERAGE
+#endif
+
+#ifndef CONTRACT_PROFILE_CYCLES
+#define CONTRACT_PROFILE_CYCLES (CONTRACT_PROFILE && !CONTRACT_COVERAGE)
+#endif
+
+/**
+ * @brief Lookup layout of contract_strerror(), see contract_errors.c
+ *
+ * Table bytes for the 57 messages of POSIX_ERRORS, errno 0 to 131, besides the 1.2 KB of text:
+ * - CONTRACT_ERRNO_DIRECT: a uint16_t message offset per errno, one load, 264 bytes (the default)
+ * - CONTRACT_ERRNO_DENSE: a uint8_t errno to message index map plus a uint16_t offset per message, two loads, 248 bytes
+ * - CONTRACT_ERRNO_SCAN: a uint8_t list of the codes searched with memchr() plus a uint16_t offset per code, 173 bytes
+ */
+#define CONTRACT_ERRNO_DIRECT 0
+#define CONTRACT_ERRNO_DENSE 1
+#define CONTRACT_ERRNO_SCAN 2
+
+#ifndef CONTRACT_ERRNO_TABLE
+#define CONTRACT_ERRNO_TABLE CONTRACT_ERRNO_DIRECT
+#endif
+
+/**
+ * @brief Leave the condition and message text of every contract out of the binary
+ *
+ * With CONTRACT_STRIP_TEXT 1 the site descriptors keep only file, line and errno, and reports carry the
+ * site id in place of the condition, e.g. main.c:42|#1A2B002A|22(Invalid argument)|
+ * The text is recovered offline by contract_decode from the site table (contract_site_dump()) of an
+ * unstripped build of the same sources, the site ids only depend on file and line.
+ */
+#ifndef CONTRACT_STRIP_TEXT
+#define CONTRACT_STRIP_TEXT 0
+#endif
+
+/**
+ * @brief Longest report line formatted by contract_format(), longer lines are truncated
+ */
+#ifndef CONTRACT_LINE_MAX
+#define CONTRACT_LINE_MAX 256
+#endif
+
+/**
+ * @brief Contracts compiled out by CONTRACT_LEVEL become optimizer hints up to CONTRACT_ASSUME_LEVEL
+ *
+ * A release build such as
+ *     -dCONTRACT_LEVEL=1 -dCONTRACT_ASSUME_LEVEL=3
+ * checks every require and states every ensure and invariant to the optimizer through CONTRACT_ASSUME,
+ * so require_aligned() may license aligned vector loads and ensure_in_range() remove later bounds
+ * checks, while audits still vanish. Contracts of a group switched off are assumed alike. The try_*
+ * forms return POSIX_SUCCESS unchecked as before.
+ *
+ * The default, CONTRACT_LEVEL_NONE, assumes nothing. Only assume contracts that have held throughout
+ * testing: a false assumption is undefined behaviour, not a report. Compilers without an assume hint
+ * drop the contracts as usual.
+ */
+#ifndef CONTRACT_ASSUME_LEVEL
+#define CONTRACT_ASSUME_LEVEL CONTRACT_LEVEL_NONE
+#endif
+
+/**
+ * @brief Compiler hints for the contract hot and cold paths
+ *
+ * - CONTRACT_LIKELY / CONTRACT_UNLIKELY  branch prediction hints (__builtin_expect)
+ * - CONTRACT_NORETURN                    the function never returns to its caller
+ * - CONTRACT_COLD                        the function is rarely called, keep it out of line and out of the hot text
+ *
+ * GCC and Clang use attributes, MSVC uses __declspec. Open Watcom has no expect builtin, its noreturn
+ * equivalent is "#pragma aux <name> aborts" which contract.h applies to _contract_fail() directly.
+ * Other compilers fall back to the plain condition, which is still correct only unhinted.
+ */
+#if defined(__GNUC__) || defined(__clang__)
+#define CONTRACT_LIKELY(x)      __builtin_expect(!!(x), 1)
+#define CONTRACT_UNLIKELY(x)    __builtin_expect(!!(x), 0)
+#define CONTRACT_NORETURN       __attribute__((noreturn))
+#define CONTRACT_COLD           __attribute__((cold, noinline))
+#elif defined(_MSC_VER)
+#define CONTRACT_LIKELY(x)      (x)
+#define CONTRACT_UNLIKELY(x)    (x)
+#define CONTRACT_NORETURN       __declspec(noreturn)
+#define CONTRACT_COLD           __declspec(noinline)
+#else
+#define CONTRACT_LIKELY(x)      (x)
+#define CONTRACT_UNLIKELY(x)    (x)
+#define CONTRACT_NORETURN
+#define CONTRACT_COLD
+#endif
+
+/**
+ * @brief CONTRACT_ASSUME(cond) lets the optimizer take cond as true, see CONTRACT_ASSUME_LEVEL
+ *
+ * - Clang    __builtin_assume()
+ * - GCC 13+  __attribute__((assume()))
+ * - MSVC     __assume()
+ * none of which evaluates the condition. Older GCC only has if (!(cond)) __builtin_unreachable(), which
+ * still evaluates a condition calling a function it cannot see through, e.g. require_all_in_range(),
+ * so it is used only when CONTRACT_ASSUME_UNREACHABLE is 1 and the assumed contracts are plain comparisons.
+ *
+ * Use it as a statement. CONTRACT_HAVE_ASSUME is 0 elsewhere, Open Watcom included, and CONTRACT_ASSUME
+ * is not defined.
+ */
+#ifndef CONTRACT_ASSUME_UNREACHABLE
+#define CONTRACT_ASSUME_UNREACHABLE 0
+#endif
+
+#if defined(__clang__)
+#define CONTRACT_ASSUME(cond)   __builtin_assume(!!(cond))
+#define CONTRACT_HAVE_ASSUME 1
+#elif defined(__GNUC__) && __GNUC__ >= 13
+#define CONTRACT_ASSUME(cond)   __attribute__((assume(!!(cond))))
+#define CONTRACT_HAVE_ASSUME 1
+#elif defined(__GNUC__) && CONTRACT_ASSUME_UNREACHABLE
+#define CONTRACT_ASSUME(cond)   ((cond) ? (void)0 : __builtin_unreachable())
+#define CONTRACT_HAVE_ASSUME 1
+#elif defined(_MSC_VER)
+#define CONTRACT_ASSUME(cond)   __assume(cond)
+#define CONTRACT_HAVE_ASSUME 1
+#else
+#define CONTRACT_HAVE_ASSUME 0
+#endif
+
+/**
+ * @brief CONTRACT_HAVE_CLEANUP is 1 where __attribute__((cleanup)) runs code as a block is left
+ *
+ * With it every way out of the block runs it, a plain return included: the deferred checks of an
+ * ensure_frame (contract_defer.h) and the release of ensure_old() captures (contract_old.h). Without it,
+ * Open Watcom in particular, deferred checks run in return_ensured() and ensure_exit() only, and old
+ * values fall back to a ring.
+ */
+#ifndef CONTRACT_HAVE_CLEANUP
+#if defined(__GNUC__) || defined(__clang__)
+#define CONTRACT_HAVE_CLEANUP 1
+#else
+#define CONTRACT_HAVE_CLEANUP 0
+#endif
+#endif
+
+/**
+ * @brief Thread local storage class for per thread contract state, e.g. the longjmp recovery point
+ *
+ * Empty on compilers without thread local storage, Watcom DOS being single threaded anyway.
+ */
+#ifndef CONTRACT_THREAD_LOCAL
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L && !defined(__STDC_NO_THREADS__)
+#define CONTRACT_THREAD_LOCAL   _Thread_local
+#elif defined(__GNUC__) || defined(__clang__)
+#define CONTRACT_THREAD_LOCAL   __thread
+#elif defined(_MSC_VER)
+#define CONTRACT_THREAD_LOCAL   __declspec(thread)
+#else
+#define CONTRACT_THREAD_LOCAL
+#endif
+#endif
+
+/**
+ * @brief CONTRACT_HAVE_THREADS is 1 where POSIX threads are available for the contract runtime's
+ *        background workers (asynchronous log drain, audits, probes), otherwise 0 and the same work
+ *        is done by explicit calls such as contract_flush() from the application's own loop
+ */
+#ifndef CONTRACT_HAVE_THREADS
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+#if defined(_POSIX_THREADS) && (_POSIX_THREADS > 0)
+#define CONTRACT_HAVE_THREADS 1
+#else
+#define CONTRACT_HAVE_THREADS 0
+#endif
+#endif
+
+/**
+ * @brief Short source file name stored in the contract site descriptors, worked out at compile time
+ *
+ * Uses __FILE_NAME__ where the compiler provides it (GCC 12+, Clang 9+), else the CONTRACT_SOURCE_NAME
+ * define the build injects per source file (see CMakeLists.txt), else falls back to the full __FILE__.
+ * Only the short name is then stored in the binary and _contract_fail() has no path to strip.
+ *
+ * @note CONTRACT_SOURCE_NAME names the translation unit, so contracts inside a header report the
+ *       including .c file when __FILE_NAME__ is unavailable, the line number is still the header's.
+ */
+#ifndef CONTRACT_FILE
+#if defined(__FILE_NAME__)
+#define CONTRACT_FILE __FILE_NAME__
+#elif defined(CONTRACT_SOURCE_NAME)
+#define CONTRACT_FILE CONTRACT_SOURCE_NAME
+#else
+#define CONTRACT_FILE __FILE__
+#endif
+#endif
+
+/**
+ * @brief Storage class for the small helper functions defined in the contract headers
+ */
+#ifndef CONTRACT_INLINE
+#if defined(__GNUC__) || defined(__clang__)
+#define CONTRACT_INLINE static __inline__
+#elif defined(_MSC_VER) || defined(__WATCOMC__)
+#define CONTRACT_INLINE static __inline
+#elif defined(__STDC_VERSION__) && __STDC_VERSION__ >= 199901L
+#define CONTRACT_INLINE static inline
+#else
+#define CONTRACT_INLINE static
+#endif
+#endif
+
+/**
+ * @brief Placement of the per site contract descriptors
+ *
+ * On ELF targets built with GCC or Clang every contract_site_t is emitted into the "contract_sites" section,
+ * which the linker brackets with __start_contract_sites / __stop_contract_sites. The descriptors then form
+ * a table of every contract compiled into the binary, walked by contract_site_foreach(), at no run time cost.
+ * The explicit alignment keeps the descriptors packed at sizeof(contract_site_t), GCC would otherwise pad
+ * objects of 32 bytes and more out to 32 byte boundaries and break the table stride.
+ * Elsewhere (Watcom, DOS) CONTRACT_HAVE_SITE_TABLE is 0 and the descriptors are ordinary static data.
+ */
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__ELF__)
+#define CONTRACT_HAVE_SITE_TABLE 1
+#define CONTRACT_SITE           __attribute__((used, section("contract_sites"), aligned(sizeof(void *))))
+#else
+#define CONTRACT_HAVE_SITE_TABLE 0
+#define CONTRACT_SITE
+#endif
+
+#endif
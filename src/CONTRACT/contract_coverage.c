@@ -0,0 +1,324 @@
+#define _POSIX_C_SOURCE 200112L   // fcntl locks
+
+#include "contract_coverage.h"
+#include "contract_profile.h"
+#include "contract_atomic.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define COVERAGE_HAVE_LOCK 1
+#include <fcntl.h>
+#include <unistd.h>
+#else
+#define COVERAGE_HAVE_LOCK 0
+#endif
+
+#define COVERAGE_LINE_MAX 512
+#define COVERAGE_PATH_MAX 1024
+
+typedef struct {
+    unsigned long id;
+    double evals;
+    double hits;
+    char *site;                 // "file:line|cond", owned
+} coverage_entry_t;
+
+typedef struct {
+    coverage_entry_t *v;
+    size_t n;
+    size_t cap;
+    int oom;
+} coverage_t;
+
+static int coverage_add(coverage_t *c, unsigned long id, double evals, double hits, const char *site, size_t len) {
+    coverage_entry_t *e;
+
+    if (c->n == c->cap) {
+        size_t cap = c->cap ? c->cap * 2 : 64;
+        e = (coverage_entry_t *)realloc(c->v, cap * sizeof(*e));
+        if (!e) {
+            c->oom = 1;
+            return 0;
+        }
+        c->v = e;
+        c->cap = cap;
+    }
+    e = &c->v[c->n];
+    e->site = (char *)malloc(len + 1);
+    if (!e->site) {
+        c->oom = 1;
+        return 0;
+    }
+    memcpy(e->site, site, len);
+    e->site[len] = '\0';
+    e->id = id;
+    e->evals = evals;
+    e->hits = hits;
+    c->n++;
+    return 1;
+}
+
+static void coverage_free(coverage_t *c) {
+    size_t i;
+
+    for (i = 0; i < c->n; i++) free(c->v[i].site);
+    free(c->v);
+}
+
+static int compare_site_ptr(const void *a, const void *b) {
+    const contract_site_t *sa = (*(const contract_profile_t * const *)a)->site;
+    const contract_site_t *sb = (*(const contract_profile_t * const *)b)->site;
+
+    return sa < sb ? -1 : sa > sb;
+}
+
+static int compare_id(const void *a, const void *b) {
+    const coverage_entry_t *ea = (const coverage_entry_t *)a;
+    const coverage_entry_t *eb = (const coverage_entry_t *)b;
+
+    return ea->id < eb->id ? -1 : ea->id > eb->id;
+}
+
+static int compare_evals(const void *a, const void *b) {
+    const coverage_entry_t *ea = (const coverage_entry_t *)a;
+    const coverage_entry_t *eb = (const coverage_entry_t *)b;
+
+    if (ea->evals != eb->evals) return ea->evals > eb->evals ? -1 : 1;
+    return compare_id(a, b);
+}
+
+typedef struct {
+    const contract_profile_t **v;
+    size_t n;
+    coverage_t *out;
+} coverage_join_t;
+
+static void collect_profile(const contract_profile_t *prof, void *ctx) {
+    coverage_join_t *j = (coverage_join_t *)ctx;
+
+    if (j->v) j->v[j->n] = prof;
+    j->n++;
+}
+
+static void coverage_site(coverage_t *c, const contract_site_t *site, double evals) {
+    char text[COVERAGE_LINE_MAX];
+    int len;
+
+    if (site->cond) len = sprintf(text, "%.*s:%d|%.*s", 128, site->file, site->line, COVERAGE_LINE_MAX - 160, site->cond);
+    else len = sprintf(text, "%.*s:%d|#%08lX", 128, site->file, site->line, contract_site_id(site));
+    coverage_add(c, contract_site_id(site), evals, site->stats ? (double)site->stats->hits : 0.0, text, (size_t)len);
+}
+
+#if CONTRACT_HAVE_SITE_TABLE
+static void join_site(const contract_site_t *site, void *ctx) {
+    coverage_join_t *j = (coverage_join_t *)ctx;
+    contract_profile_t key;
+    const contract_profile_t *pkey = &key;
+    const contract_profile_t **found;
+
+    key.site = site;
+    found = (const contract_profile_t **)bsearch(&pkey, j->v, j->n, sizeof(*j->v), compare_site_ptr);
+    coverage_site(j->out, site, found ? (double)(*found)->evals : 0.0);
+}
+#endif
+
+// Every site of this process, from the site table where there is one, else the evaluated ones
+static void coverage_collect(coverage_t *c) {
+    coverage_join_t j;
+    size_t n;
+
+    j.v = NULL;
+    j.n = 0;
+    j.out = c;
+    contract_profile_foreach(collect_profile, &j);
+    n = j.n;
+    if (n) {
+        j.v = (const contract_profile_t **)malloc(n * sizeof(*j.v));
+        if (!j.v) {
+            c->oom = 1;
+            return;
+        }
+        j.n = 0;
+        contract_profile_foreach(collect_profile, &j);
+        if (j.n > n) j.n = n;       // sites registered since the count are left out
+        qsort(j.v, j.n, sizeof(*j.v), compare_site_ptr);
+    }
+#if CONTRACT_HAVE_SITE_TABLE
+    contract_site_foreach(join_site, &j);
+#else
+    for (n = 0; n < j.n; n++) coverage_site(c, j.v[n]->site, (double)j.v[n]->evals);
+#endif
+    free((void *)j.v);
+}
+
+// Sums entries with the same id, the first keeps its site text
+static void coverage_fold(coverage_t *c) {
+    size_t i, k = 0;
+
+    if (!c->n) return;
+    qsort(c->v, c->n, sizeof(*c->v), compare_id);
+    for (i = 1; i < c->n; i++) {
+        if (c->v[i].id == c->v[k].id) {
+            c->v[k].evals += c->v[i].evals;
+            c->v[k].hits += c->v[i].hits;
+            free(c->v[i].site);
+        } else {
+            c->v[++k] = c->v[i];
+        }
+    }
+    c->n = k + 1;
+}
+
+static int coverage_write(FILE *out, coverage_t *c) {
+    size_t i, evaluated = 0;
+
+    qsort(c->v, c->n, sizeof(*c->v), compare_evals);
+    for (i = 0; i < c->n; i++) evaluated += c->v[i].evals > 0;
+    fprintf(out, "# contract coverage, %lu sites, %lu evaluated\n", (unsigned long)c->n, (unsigned long)evaluated);
+    fprintf(out, "# %8s %16s %10s  site\n", "id", "evals", "hits");
+    for (i = 0; i < c->n; i++) {
+        fprintf(out, "%08lX %18.0f %10.0f  %s\n", c->v[i].id, c->v[i].evals, c->v[i].hits, c->v[i].site);
+    }
+    return ferror(out) ? -1 : 0;
+}
+
+unsigned contract_coverage_dump(FILE *out) {
+    coverage_t c;
+    unsigned n = 0;
+
+    memset(&c, 0, sizeof(c));
+    coverage_collect(&c);
+    if (!c.oom) {
+        coverage_fold(&c);
+        coverage_write(out, &c);
+        n = (unsigned)c.n;
+    }
+    coverage_free(&c);
+    return n;
+}
+
+// Entries of an earlier report, lines that do not parse are dropped
+static void coverage_read(coverage_t *c, FILE *in) {
+    char line[COVERAGE_LINE_MAX + 64];
+    unsigned long id;
+    double evals, hits;
+    char *p, *end;
+
+    while (fgets(line, sizeof(line), in)) {
+        if (line[0] == '#') continue;
+        id = strtoul(line, &p, 16);
+        if (p == line) continue;
+        evals = strtod(p, &end);
+        if (end == p) continue;
+        hits = strtod(end, &p);
+        if (p == end) continue;
+        while (*p == ' ') p++;
+        end = p + strlen(p);
+        while (end > p && (end[-1] == '\n' || end[-1] == '\r')) end--;
+        if (!coverage_add(c, id, evals, hits, p, (size_t)(end - p))) return;
+    }
+}
+
+/*
+ * Concurrent test runs merge into the same report, so the read, sum and rewrite happen under an exclusive
+ * fcntl() lock on "<path>.lock", and the new report is written to "<path>.tmp" and renamed over the old
+ * one: a run killed halfway leaves the previous report intact. Without fcntl() (DOS) there is no lock.
+ */
+#if COVERAGE_HAVE_LOCK
+static int coverage_lock(const char *path) {
+    struct flock lk;
+    int fd = open(path, O_RDWR | O_CREAT, 0666);
+
+    if (fd < 0) return -1;
+    memset(&lk, 0, sizeof(lk));
+    lk.l_type = F_WRLCK;
+    lk.l_whence = SEEK_SET;
+    while (fcntl(fd, F_SETLKW, &lk) != 0) {
+        if (errno != EINTR) {
+            int e = errno;
+
+            close(fd);
+            errno = e;
+            return -1;
+        }
+    }
+    return fd;
+}
+#endif
+
+static posix_error_t coverage_replace(const char *path, const char *tmp, coverage_t *c) {
+    posix_error_t err = POSIX_SUCCESS;
+    FILE *f = fopen(tmp, "w");
+
+    if (!f) return (posix_error_t)errno;
+    if (coverage_write(f, c) != 0) err = POSIX_EIO;
+    if (fclose(f) != 0 && err == POSIX_SUCCESS) err = (posix_error_t)errno;
+    if (err == POSIX_SUCCESS) {
+#if !COVERAGE_HAVE_LOCK
+        remove(path);               // DOS and Windows rename() will not replace a file
+#endif
+        if (rename(tmp, path) != 0) err = (posix_error_t)errno;
+    }
+    if (err != POSIX_SUCCESS) remove(tmp);
+    return err;
+}
+
+posix_error_t contract_coverage_merge(const char *path) {
+    char side[COVERAGE_PATH_MAX + 8];
+    posix_error_t err;
+    coverage_t c;
+    FILE *f;
+    size_t len = strlen(path);
+#if COVERAGE_HAVE_LOCK
+    int lock;
+#endif
+
+    if (len > COVERAGE_PATH_MAX) return POSIX_ENAMETOOLONG;
+    memcpy(side, path, len);
+#if COVERAGE_HAVE_LOCK
+    memcpy(side + len, ".lock", 6);
+    lock = coverage_lock(side);
+    if (lock < 0) return (posix_error_t)errno;
+#endif
+
+    memset(&c, 0, sizeof(c));
+    f = fopen(path, "r");
+    if (f) {
+        coverage_read(&c, f);
+        fclose(f);
+    }
+    coverage_collect(&c);
+    if (c.oom) {
+        err = POSIX_ENOMEM;
+    } else {
+        coverage_fold(&c);
+        memcpy(side + len, ".tmp", 5);
+        err = coverage_replace(path, side, &c);
+    }
+    coverage_free(&c);
+#if COVERAGE_HAVE_LOCK
+    close(lock);                    // releases the lock, the lock file is left for the next run
+#endif
+    return err;
+}
+
+static void contract_coverage_exit(void) {
+    const char *path = getenv("CONTRACT_COVERAGE");
+
+    (void)contract_coverage_merge(path && *path ? path : CONTRACT_COVERAGE_FILE);
+}
+
+void _contract_coverage_arm(void) {
+    static int armed = 0;
+    int expected = 0;
+
+    if (CONTRACT_ATOMIC_CAS_STRONG(&armed, &expected, 1)) atexit(contract_coverage_exit);
+}
+
+#if CONTRACT_COVERAGE && CONTRACT_HAVE_SITE_TABLE
+// A binary that never evaluates a contract still reports its sites, those at 0 are the point of the report
+__attribute__((constructor)) static void contract_coverage_init(void) {
+    _contract_coverage_arm();
+}
+#endif
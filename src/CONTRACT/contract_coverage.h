@@ -0,0 +1,55 @@
+/**
+ * @file contract_coverage.h
+ * @brief Per site evaluation and violation counts of every contract in the binary, merged across runs
+ * @version 0.1.4
+ * @license MIT
+ * @author Jeremy Thornton
+ */
+#ifndef CONTRACT_COVERAGE_H
+#define CONTRACT_COVERAGE_H
+
+#include "contract.h"
+#include <stdio.h>
+
+/**
+ * @brief Writes the coverage of this process, one line per site, most evaluated first
+ *
+ *     # contract coverage, 3 sites, 2 evaluated
+ *     #       id            evals       hits  site
+ *     9A3E0005             100000          0  main.c:5|x >= 0
+ *     9A3E0006               1000          2  main.c:6|strlen(s) < 100000
+ *     9A3E0009                  0          0  main.c:9|fd >= 0
+ *
+ * The id is contract_site_id(), the same in every build of the source, so lines of different runs and
+ * targets are matched on it. Evaluations are counted by CONTRACT_PROFILE (CONTRACT_COVERAGE implies it),
+ * which leaves the try_* forms out, hits are the violations counted by CONTRACT_STATS. The site table
+ * supplies the sites never evaluated, without it (Watcom, DOS) only evaluated sites are listed.
+ *
+ * @param out Stream to write the report to
+ * @return Number of sites written, 0 if there was no memory to sort them
+ */
+unsigned contract_coverage_dump(FILE *out);
+
+/**
+ * @brief Adds the coverage of this process to the report in path, creating it if needed
+ *
+ * Counts of sites already in the file are summed by id, sites of other binaries are kept, so any number
+ * of test runs accumulate into one report: hot sites never violated are the candidates for sampling
+ * or CONTRACT_ASSUME_LEVEL, sites at 0 evaluations are not exercised by the tests.
+ *
+ * A CONTRACT_COVERAGE build calls it at exit, on the file named by the CONTRACT_COVERAGE environment
+ * variable, else CONTRACT_COVERAGE_FILE. Runs in parallel serialise on an fcntl() lock of path.lock, and
+ * the report is rewritten through path.tmp and rename(), so no run's counts are lost or half written.
+ *
+ * @param path Report to update
+ * @return POSIX_SUCCESS, POSIX_ENOMEM, POSIX_ENAMETOOLONG, or the errno of locking, writing or renaming
+ */
+posix_error_t contract_coverage_merge(const char *path);
+
+/**
+ * @brief Registers the CONTRACT_COVERAGE exit dump, once, from a constructor on ELF targets and from the
+ *        profiler's first site elsewhere
+ */
+void _contract_coverage_arm(void);
+
+#endif
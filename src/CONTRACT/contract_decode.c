@@ -0,0 +1,227 @@
+#include "contract_decode.h"
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    unsigned long id;
+    contract_site_t site;
+} contract_entry_t;
+
+typedef struct {
+    contract_entry_t *entries;
+    size_t count;
+    size_t capacity;
+} contract_table_t;
+
+static char *copy_field(const char *start, const char *end) {
+    size_t len = (size_t)(end - start);
+    char *s = (char *)malloc(len + 1);
+
+    if (!s) return NULL;
+    memcpy(s, start, len);
+    s[len] = '\0';
+    return s;
+}
+
+// Splits the next tab separated field off *p, the last field runs to the end of the line
+static char *next_field(char **p, int last) {
+    char *start = *p;
+    char *end = last ? start + strcspn(start, "\r\n") : strchr(start, '\t');
+
+    if (!end) return NULL;
+    *p = last ? end : end + 1;
+    return copy_field(start, end);
+}
+
+static int load_table(FILE *table, contract_table_t *t) {
+    char line[1024];
+    char *p, *file, *cond, *msg;
+    contract_entry_t *grown;
+    contract_entry_t *e;
+
+    while (fgets(line, sizeof(line), table)) {
+        p = line;
+        if (t->count == t->capacity) {
+            t->capacity = t->capacity ? t->capacity * 2 : 64;
+            grown = (contract_entry_t *)realloc(t->entries, t->capacity * sizeof(*grown));
+            if (!grown) return -1;
+            t->entries = grown;
+        }
+        e = &t->entries[t->count];
+        e->id = strtoul(p, &p, 16);
+        if (*p++ != '\t') continue;
+        file = next_field(&p, 0);
+        e->site.line = (int)strtol(p, &p, 10);
+        p += (*p == '\t');
+        e->site.err = (posix_error_t)strtol(p, &p, 10);
+        p += (*p == '\t');
+        cond = next_field(&p, 0);
+        msg = next_field(&p, 1);
+        if (!file || !cond || !msg) {
+            free(file);
+            free(cond);
+            free(msg);
+            continue;
+        }
+        e->site.file = file;
+        e->site.cond = cond;
+        e->site.msg = msg;
+        t->count++;
+    }
+    return 0;
+}
+
+static int compare_entry(const void *a, const void *b) {
+    unsigned long ia = ((const contract_entry_t *)a)->id;
+    unsigned long ib = ((const contract_entry_t *)b)->id;
+    return ia < ib ? -1 : ia > ib;
+}
+
+// Several contracts on one source line share a site id, prefer the one whose errno matches the record
+static contract_entry_t *find_entry(contract_table_t *t, unsigned long id, posix_error_t err) {
+    contract_entry_t key;
+    contract_entry_t *found;
+    contract_entry_t *first;
+    contract_entry_t *last;
+
+    if (!t->count) return NULL;
+    key.id = id;
+    found = (contract_entry_t *)bsearch(&key, t->entries, t->count, sizeof(*t->entries), compare_entry);
+    if (!found) return NULL;
+    for (first = found; first > t->entries && first[-1].id == id; first--) { }
+    for (last = found; last + 1 < t->entries + t->count && last[1].id == id; last++) { }
+    for (; first <= last; first++) {
+        if (first->site.err == err) return first;
+    }
+    return found;
+}
+
+static void free_table(contract_table_t *t) {
+    size_t i;
+
+    for (i = 0; i < t->count; i++) {
+        free((char *)t->entries[i].site.file);
+        free((char *)t->entries[i].site.cond);
+        free((char *)t->entries[i].site.msg);
+    }
+    free(t->entries);
+}
+
+static void open_table(FILE *table, contract_table_t *t) {
+    if (table) load_table(table, t);
+    if (t->count) qsort(t->entries, t->count, sizeof(*t->entries), compare_entry);
+}
+
+static unsigned long get_u32(const unsigned char *p) {
+    return (unsigned long)p[0] | ((unsigned long)p[1] << 8) | ((unsigned long)p[2] << 16) | ((unsigned long)p[3] << 24);
+}
+
+long contract_decode_log(FILE *log, FILE *table, FILE *out) {
+    contract_table_t t = { NULL, 0, 0 };
+    unsigned char header[8];
+    unsigned char rec[5];
+    char text[CONTRACT_LINE_MAX];
+    char unknown[16];
+    contract_entry_t *found;
+    contract_site_t missing;
+    unsigned long id;
+    unsigned long delta;
+    time_t stamp;
+    long count = 0;
+    int shift, c;
+
+    if (fread(header, 1, sizeof(header), log) != sizeof(header) || memcmp(header, CONTRACT_BINLOG_MAGIC, 4) != 0) {
+        return -1;
+    }
+    stamp = (time_t)get_u32(header + 4);
+
+    open_table(table, &t);
+
+    while (fread(rec, 1, sizeof(rec), log) == sizeof(rec)) {
+        delta = 0;
+        shift = 0;
+        do {
+            c = fgetc(log);
+            if (c == EOF) break;
+            delta |= (unsigned long)(c & 0x7F) << shift;
+            shift += 7;
+        } while (c & 0x80);
+        stamp += (time_t)delta;
+
+        id = get_u32(rec);
+        found = find_entry(&t, id, (posix_error_t)rec[4]);
+        if (found) {
+            contract_format(text, sizeof(text), &found->site, (posix_error_t)rec[4], stamp);
+        } else {
+            sprintf(unknown, "#%08lX", id);
+            missing.file = "?";
+            missing.line = (int)(id & 0xFFFF);
+            missing.cond = unknown;
+            missing.msg = "unknown site";
+            missing.err = (posix_error_t)rec[4];
+            contract_format(text, sizeof(text), &missing, missing.err, stamp);
+        }
+        fputs(text, out);
+        count++;
+    }
+
+    free_table(&t);
+    return count;
+}
+
+// Replaces a CONTRACT_TIMESTAMP_RAW "[@seconds]" prefix in place by the local "[YYYY-MM-DD HH:MM:SS]"
+static int expand_stamp(char *line, size_t size) {
+    char datetime[24];
+    char *end;
+    time_t stamp;
+    size_t len, rest;
+
+    if (line[0] != '[' || line[1] != '@') return 0;
+    stamp = (time_t)strtol(line + 2, &end, 10);
+    if (end == line + 2 || *end != ']') return 0;
+    len = strftime(datetime, sizeof(datetime), "[%Y-%m-%d %H:%M:%S]", localtime(&stamp));
+    rest = strlen(end + 1) + 1;
+    if (!len || len + rest > size) return 0;
+    memmove(line + len, end + 1, rest);
+    memcpy(line, datetime, len);
+    return 1;
+}
+
+long contract_decode_text(FILE *log, FILE *table, FILE *out) {
+    contract_table_t t = { NULL, 0, 0 };
+    char line[CONTRACT_LINE_MAX * 2];
+    contract_entry_t *found;
+    char *id, *end, *last;
+    unsigned long site;
+    long count = 0;
+    int stamped;
+
+    open_table(table, &t);
+    while (fgets(line, sizeof(line), log)) {
+        // [date] file:line|#XXXXXXXX|errno(name)| (index N)
+        stamped = expand_stamp(line, sizeof(line));
+        found = NULL;
+        id = strstr(line, "|#");
+        last = strrchr(line, '|');
+        if (id) {
+            site = strtoul(id + 2, &end, 16);
+            if (end == id + 10 && *end == '|' && end < last) {
+                found = find_entry(&t, site, (posix_error_t)strtol(end + 1, NULL, 10));
+            }
+        }
+        if (!found || !*found->site.cond) {     // not stripped, unknown, or a table from a stripped build
+            fputs(line, out);
+            count += stamped;
+            continue;
+        }
+        fwrite(line, 1, (size_t)(id + 1 - line), out);
+        fputs(found->site.cond, out);
+        fwrite(end, 1, (size_t)(last + 1 - end), out);
+        fputs(found->site.msg, out);
+        fputs(last + 1, out);     // the message is empty when stripped, only the report suffixes follow
+        count++;
+    }
+
+    free_table(&t);
+    return count;
+}
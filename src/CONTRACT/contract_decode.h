@@ -0,0 +1,45 @@
+#ifndef CONTRACT_DECODE_H
+#define CONTRACT_DECODE_H
+
+#include "contract_binlog.h"
+#include <stdio.h>
+
+/**
+ * @brief Decodes a binary contract log back into the standard text report format.
+ *
+ * Reads the site table written by contract_site_dump() into memory, then walks the binary log
+ * written by contract_binlog_*() and prints one report line per record, exactly as contract_report()
+ * would have at failure time:
+ *     [YYYY-MM-DD HH:MM:SS] filename:line|condition|errno(errno_name)|message
+ *
+ * Records whose site id is not in the table are still printed, with the id in place of the condition:
+ *     [2025-07-30 19:12:13] ?:42|#1A2B002A|22(Invalid argument)|unknown site
+ *
+ * @param log Binary log opened in binary mode
+ * @param table Site table produced by contract_site_dump() for the same sources
+ * @param out Stream receiving the text report
+ * @return Number of records decoded, or -1 if log does not start with a CONTRACT_BINLOG_MAGIC header
+ *
+ * @note Contracts sharing a source line share a site id, they are told apart by their errno only.
+ * @note This is a host-side tool, only linked into the contract_decode utility.
+ */
+long contract_decode_log(FILE *log, FILE *table, FILE *out);
+
+/**
+ * @brief Restores condition and message in a text report written by a CONTRACT_STRIP_TEXT build.
+ *
+ * Copies the text log to out line by line, expanding every stripped report
+ *     [2025-07-30 19:12:13] main.c:42|#1A2B002A|22(Invalid argument)|
+ * from the site table to
+ *     [2025-07-30 19:12:13] main.c:42|ptr != NULL|22(Invalid argument)|NULL buffer!
+ * A CONTRACT_TIMESTAMP_RAW "[@seconds]" timestamp is converted to local time on the way, and this works
+ * without a table too. Other lines, and reports of sites missing from the table, are copied unchanged.
+ *
+ * @param log Text log, e.g. a captured stderr
+ * @param table Site table produced by contract_site_dump() from an unstripped build of the same sources
+ * @param out Stream receiving the expanded log
+ * @return Number of lines expanded
+ */
+long contract_decode_text(FILE *log, FILE *table, FILE *out);
+
+#endif
@@ -0,0 +1,29 @@
+#include "contract_defer.h"
+
+CONTRACT_THREAD_LOCAL contract_defer_stack_t _contract_defer;
+
+// Reported at the registering site, with its condition but the stack's own message and error
+void _contract_defer_full(const contract_site_t *site) {
+    (void)_contract_fail_at(site->cond, "Deferred ensure stack full, CONTRACT_DEFER_MAX", site->file, site->line, POSIX_ENOMEM);
+}
+
+void _contract_defer_run(const contract_frame_t *frame) {
+    contract_defer_stack_t *s = &_contract_defer;
+    unsigned lo = frame->top;
+    unsigned hi = s->top;
+    unsigned i;
+
+    // entries of an inner frame popped over are skipped, a frame above the top has lost its own already
+    if (lo > hi) lo = hi;
+    for (i = lo; i < hi; i++) {
+        const contract_deferred_t *d = &s->entry[i];
+
+        if (d->frame != frame->serial) continue;
+        if (CONTRACT_UNLIKELY(!d->check(d->arg))) {
+            s->top = lo;
+            (void)_contract_fail(d->site);
+            s->top = hi;
+        }
+    }
+    s->top = lo;
+}
@@ -0,0 +1,155 @@
+/**
+ * @file contract_defer.h
+ * @brief Deferred postconditions, registered once at function entry and checked together on exit
+ * @version 0.1.4
+ * @license MIT
+ * @author Jeremy Thornton
+ */
+#ifndef CONTRACT_DEFER_H
+#define CONTRACT_DEFER_H
+
+#include "contract.h"
+
+/**
+ * @brief Entries of the per thread deferred ensure stack, shared by all frames live on the thread
+ *
+ * A registration past the last entry is reported through the handler as POSIX_ENOMEM and not checked.
+ * The stack is static data, CONTRACT_DEFER_MAX * 4 words per thread.
+ */
+#ifndef CONTRACT_DEFER_MAX
+#define CONTRACT_DEFER_MAX 32
+#endif
+
+/**
+ * @brief Deferred condition, 1 if it holds for arg
+ */
+typedef int (*contract_check_t)(const void *arg);
+
+typedef struct {
+    const contract_site_t *site;
+    contract_check_t check;
+    const void *arg;
+    unsigned long frame;                            /**< Serial of the frame that registered it */
+} contract_deferred_t;
+
+typedef struct {
+    unsigned top;                                   /**< Entries in use */
+    unsigned long frames;                           /**< Serial of the last frame entered, 0 before the first */
+    contract_deferred_t entry[CONTRACT_DEFER_MAX];
+} contract_defer_stack_t;
+
+/**
+ * @brief A frame opened by ensure_frame, the stack top at its entry and its serial on the thread
+ */
+typedef struct {
+    unsigned top;
+    unsigned long serial;
+} contract_frame_t;
+
+extern CONTRACT_THREAD_LOCAL contract_defer_stack_t _contract_defer;
+
+/**
+ * @brief Reports a registration that found the stack full, out of line
+ */
+CONTRACT_COLD void _contract_defer_full(const contract_site_t *site);
+
+/**
+ * @brief Checks the entries the frame registered in registration order and pops everything above its entry
+ *
+ * Entries above the frame's entry that another frame registered belong to an inner frame left by
+ * longjmp(), or by a plain return without CONTRACT_HAVE_CLEANUP. Their arguments may point into dead
+ * stack, so they are dropped unchecked.
+ *
+ * The entries stay on the stack while they are checked, so a check may itself call functions with
+ * frames of their own. They are popped before a violation is handed to the handler, one that longjmps
+ * leaves the stack as the frame found it, one that returns in a CONTRACT_RECOVERABLE build lets the
+ * remaining checks run.
+ *
+ * @param frame The frame left
+ */
+void _contract_defer_run(const contract_frame_t *frame);
+
+CONTRACT_INLINE contract_frame_t _contract_defer_enter(void) {
+    contract_frame_t frame;
+
+    frame.top = _contract_defer.top;
+    frame.serial = ++_contract_defer.frames;
+    return frame;
+}
+
+CONTRACT_INLINE void _contract_defer_push(const contract_site_t *site, contract_check_t check, const void *arg,
+    const contract_frame_t *frame) {
+    contract_defer_stack_t *s = &_contract_defer;
+
+    if (CONTRACT_UNLIKELY(s->top >= CONTRACT_DEFER_MAX)) {
+        _contract_defer_full(site);
+        return;
+    }
+    s->entry[s->top].site = site;
+    s->entry[s->top].check = check;
+    s->entry[s->top].arg = arg;
+    s->entry[s->top].frame = frame->serial;
+    s->top++;
+}
+
+// Frame exit, a frame with nothing registered costs one compare
+CONTRACT_INLINE void _contract_defer_exit(contract_frame_t *frame) {
+    if (_contract_defer.top != frame->top) _contract_defer_run(frame);
+}
+
+/**
+ * @brief Deferred ensure: ensure_frame opens a frame, ensure_at_exit() registers a postcondition in it
+ *
+ * The condition runs as check(arg) when the frame's block is left, after the return value has been
+ * computed with CONTRACT_HAVE_CLEANUP, so one registration at entry covers every exit path:
+ *
+ *     static int buffer_sane(const void *arg) { const buffer_t *b = arg; return b->len <= b->cap; }
+ *
+ *     int buffer_append(buffer_t *b, const char *s) {
+ *         ensure_frame;
+ *         ensure_at_exit(buffer_sane, b, "Buffer length past capacity");
+ *         if (!s) return_ensured(0);
+ *         ...
+ *         return_ensured(1);
+ *     }
+ *
+ * Without CONTRACT_HAVE_CLEANUP the checks run before the return expression is evaluated, so return
+ * a value already computed, and a plain return skips them. Their entries are then dropped unchecked when
+ * an enclosing frame exits, as are those of a frame left by longjmp().
+ *
+ * Deferred ensures follow CONTRACT_LEVEL_ENSURE and are never assumed, the condition does not hold
+ * where it is registered. A compiled out ensure_at_exit() still type checks check(arg).
+ *
+ * @param check contract_check_t, named in the report as check(arg)
+ * @param arg Passed to check, typically the object or result the function leaves behind
+ * @param msg Custom error message to display if contract is violated, must be a string literal
+ */
+#if CONTRACT_LEVEL >= CONTRACT_LEVEL_ENSURE
+#define _CONTRACT_DEFER(check, arg, msg, err) \
+    do { \
+        _CONTRACT_SITE(check(arg), msg, err); \
+        _contract_defer_push(&_contract_site, check, arg, &_contract_frame); \
+    } while (0)
+#if CONTRACT_HAVE_CLEANUP
+#define ensure_frame __attribute__((cleanup(_contract_defer_exit))) contract_frame_t _contract_frame = _contract_defer_enter()
+#define ensure_exit() _contract_defer_exit(&_contract_frame)
+#define return_ensured(value) return value
+#else
+#define ensure_frame contract_frame_t _contract_frame = _contract_defer_enter()
+#define ensure_exit() _contract_defer_exit(&_contract_frame)
+#define return_ensured(value) \
+    do { \
+        _contract_defer_exit(&_contract_frame); \
+        return value; \
+    } while (0)
+#endif
+#else
+#define _CONTRACT_DEFER(check, arg, msg, err) _CONTRACT_DISABLED(check(arg), msg, err)
+#define ensure_frame (void)0
+#define ensure_exit() ((void)0)
+#define return_ensured(value) return value
+#endif
+
+#define ensure_at_exit(check, arg, msg) _CONTRACT_DEFER(check, arg, msg, POSIX_EINVAL)  /// @example ensure_at_exit(list_sorted, list, "List left unsorted");
+
+#endif
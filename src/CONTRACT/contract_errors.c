@@ -1,129 +1,108 @@
 #include "contract_errors.h"
+#include "contract_config.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
 
-// packed string array of error messages
-static const char error_strings[] =
-    "Success\0"                                   // 0: POSIX_SUCCESS
-    "Operation not permitted\0"                   // 1: POSIX_EPERM
-    "No such file or directory\0"                 // 2: POSIX_ENOENT
-    "No such process\0"                           // 3: POSIX_ESRCH
-    "Interrupted system call\0"                   // 4: POSIX_EINTR
-    "Input/output error\0"                        // 5: POSIX_EIO
-    "No such device or address\0"                 // 6: POSIX_ENXIO
-    "Argument list too long\0"                    // 7: POSIX_E2BIG
-    "Exec format error\0"                         // 8: POSIX_ENOEXEC
-    "Bad file descriptor\0"                       // 9: POSIX_EBADF
-    "No child processes\0"                        // 10: POSIX_ECHILD
-    "Resource unavailable, try again\0"           // 11: POSIX_EAGAIN, POSIX_EWOULDBLOCK
-    "Out of memory\0"                             // 12: POSIX_ENOMEM
-    "Permission denied\0"                         // 13: POSIX_EACCES
-    "Bad address\0"                               // 14: POSIX_EFAULT
-    "Device or resource busy\0"                   // 16: POSIX_EBUSY
-    "File exists\0"                               // 17: POSIX_EEXIST
-    "Cross-device link\0"                         // 18: POSIX_EXDEV
-    "No such device\0"                            // 19: POSIX_ENODEV
-    "Not a directory\0"                           // 20: POSIX_ENOTDIR
-    "Is a directory\0"                            // 21: POSIX_EISDIR
-    "Invalid argument\0"                          // 22: POSIX_EINVAL
-    "Too many files open in system\0"             // 23: POSIX_ENFILE
-    "Too many open files\0"                       // 24: POSIX_EMFILE
-    "Inappropriate ioctl for device\0"            // 25: POSIX_ENOTTY
-    "Text file busy\0"                            // 26: POSIX_ETXTBSY
-    "File too large\0"                            // 27: POSIX_EFBIG
-    "Read-only file system\0"                     // 30: POSIX_EROFS
-    "Too many links\0"                            // 31: POSIX_EMLINK
-    "Broken pipe\0"                               // 32: POSIX_EPIPE
-    "Numerical argument out of domain\0"          // 33: POSIX_EDOM
-    "Result too large\0"                          // 34: POSIX_ERANGE
-    "Resource deadlock would occur\0"             // 35: POSIX_EDEADLK
-    "File name too long\0"                        // 36: POSIX_ENAMETOOLONG
-    "Directory not empty\0"                       // 39: POSIX_ENOTEMPTY
-    "Too many levels of symbolic links\0"         // 40: POSIX_ELOOP
-    "Identifier removed\0"                        // 43: POSIX_EIDRM
-    "Timer expired\0"                             // 62: POSIX_ETIME
-    "Link has been severed\0"                     // 67: POSIX_ENOLINK
-    "Protocol error\0"                            // 71: POSIX_EPROTO
-    "Value too large to be stored in data type\0" // 75: POSIX_EOVERFLOW
-    "No locks available\0"                        // 77: POSIX_ENOLCK
-    "Illegal byte sequence\0"                     // 84: POSIX_EILSEQ
-    "Message too long\0"                          // 90: POSIX_EMSGSIZE
-    "Protocol wrong type for socket\0"            // 91: POSIX_EPROTOTYPE
-    "Protocol not supported\0"                    // 93: POSIX_EPROTONOSUPPORT
-    "Operation not supported\0"                   // 95: POSIX_ENOTSUP, POSIX_EOPNOTSUPP
-    "Network is down\0"                           // 100: POSIX_ENETDOWN
-    "Network is unreachable\0"                    // 101: POSIX_ENETUNREACH
-    "Connection timed out\0"                      // 110: POSIX_ETIMEDOUT
-    "No route to host\0"                          // 113: POSIX_EHOSTUNREACH
-    "Connection already in progress\0"            // 114: POSIX_EALREADY
-    "Operation in progress\0"                     // 115: POSIX_EINPROGRESS
-    "Stale file handle\0"                         // 116: POSIX_ESTALE
-    "Operation canceled\0"                        // 125: POSIX_ECANCELED
-    "Previous owner died\0"                       // 130: POSIX_EOWNERDEAD
-    "State not recoverable\0"                     // 131: POSIX_ENOTRECOVERABLE
-    "\n";
-
-static const char* const errno_to_msg[132] = {
-    [  0] = error_strings + 0,  // "Success"
-    [  1] = error_strings + 8,  // "Operation not permitted"
-    [  2] = error_strings + 32,  // "No such file or directory"
-    [  3] = error_strings + 58,  // "No such process"
-    [  4] = error_strings + 74,  // "Interrupted system call"
-    [  5] = error_strings + 98,  // "Input/output error"
-    [  6] = error_strings + 117,  // "No such device or address"
-    [  7] = error_strings + 143,  // "Argument list too long"
-    [  8] = error_strings + 166,  // "Exec format error"
-    [  9] = error_strings + 184,  // "Bad file descriptor"
-    [ 10] = error_strings + 204,  // "No child processes"
-    [ 11] = error_strings + 223,  // "Resource unavailable, try again"
-    [ 12] = error_strings + 255,  // "Out of memory"
-    [ 13] = error_strings + 269,  // "Permission denied"
-    [ 14] = error_strings + 287,  // "Bad address"
-    [ 16] = error_strings + 299,  // "Device or resource busy"
-    [ 17] = error_strings + 323,  // "File exists"
-    [ 18] = error_strings + 335,  // "Cross-device link"
-    [ 19] = error_strings + 353,  // "No such device"
-    [ 20] = error_strings + 368,  // "Not a directory"
-    [ 21] = error_strings + 384,  // "Is a directory"
-    [ 22] = error_strings + 399,  // "Invalid argument"
-    [ 23] = error_strings + 416,  // "Too many files open in system"
-    [ 24] = error_strings + 446,  // "Too many open files"
-    [ 25] = error_strings + 466,  // "Inappropriate ioctl for device"
-    [ 26] = error_strings + 497,  // "Text file busy"
-    [ 27] = error_strings + 512,  // "File too large"
-    [ 30] = error_strings + 527,  // "Read-only file system"
-    [ 31] = error_strings + 549,  // "Too many links"
-    [ 32] = error_strings + 564,  // "Broken pipe"
-    [ 33] = error_strings + 576,  // "Numerical argument out of domain"
-    [ 34] = error_strings + 609,  // "Result too large"
-    [ 35] = error_strings + 626,  // "Resource deadlock would occur"
-    [ 36] = error_strings + 656,  // "File name too long"
-    [ 39] = error_strings + 675,  // "Directory not empty"
-    [ 40] = error_strings + 695,  // "Too many levels of symbolic links"
-    [ 43] = error_strings + 729,  // "Identifier removed"
-    [ 62] = error_strings + 748,  // "Timer expired"
-    [ 67] = error_strings + 762,  // "Link has been severed"
-    [ 71] = error_strings + 784,  // "Protocol error"
-    [ 75] = error_strings + 799,  // "Value too large to be stored in data type"
-    [ 77] = error_strings + 841,  // "No locks available"
-    [ 84] = error_strings + 860,  // "Illegal byte sequence"
-    [ 90] = error_strings + 882,  // "Message too long"
-    [ 91] = error_strings + 899,  // "Protocol wrong type for socket"
-    [ 93] = error_strings + 930,  // "Protocol not supported"
-    [ 95] = error_strings + 953,  // "Operation not supported"
-    [100] = error_strings + 977,  // "Network is down"
-    [101] = error_strings + 993,  // "Network is unreachable"
-    [110] = error_strings + 1016,  // "Connection timed out"
-    [113] = error_strings + 1037,  // "No route to host"
-    [114] = error_strings + 1054,  // "Connection already in progress"
-    [115] = error_strings + 1085,  // "Operation in progress"
-    [116] = error_strings + 1107,  // "Stale file handle"
-    [125] = error_strings + 1125,  // "Operation canceled"
-    [130] = error_strings + 1144,  // "Previous owner died"
-    [131] = error_strings + 1164,  // "State not recoverable"
+/**
+ * @brief Packed message blob, one char array member per POSIX_ERRORS entry
+ *
+ * Laying the strings out as struct members lets offsetof() compute every message's position at
+ * compile time. The leading "undefined" member sits at offset 0, so codes without an entry, whose
+ * offset table slot is zero initialised, read back as "undefined".
+ */
+#define POSIX_ERROR_MEMBER(name, num, msg) char msg_##name[sizeof(msg)];
+#define POSIX_ERROR_STRING(name, num, msg) msg,
+
+typedef struct {
+    char undefined[sizeof("undefined")];
+    POSIX_ERRORS(POSIX_ERROR_MEMBER)
+} error_strings_t;
+
+static const error_strings_t error_strings = {
+    "undefined",
+    POSIX_ERRORS(POSIX_ERROR_STRING)
+};
+
+// 2 byte offsets need the blob below 64 KiB
+typedef char error_strings_fit_uint16[sizeof(error_strings_t) <= 0xFFFFu ? 1 : -1];
+
+#define POSIX_ERROR_OFFSET(name, num, msg) [num] = (uint16_t)offsetof(error_strings_t, msg_##name),
+#define POSIX_ERROR_INDEX(name, num, msg) error_index_##name,
+#define POSIX_ERROR_CODE(name, num, msg) num,
+#define POSIX_ERROR_DENSE(name, num, msg) [num] = error_index_##name,
+#define POSIX_ERROR_DENSE_OFFSET(name, num, msg) [error_index_##name] = (uint16_t)offsetof(error_strings_t, msg_##name),
+
+#define ERRNO_LIMIT (sizeof(errno_to_msg) / sizeof(errno_to_msg[0]))
+
+#if CONTRACT_ERRNO_TABLE == CONTRACT_ERRNO_DIRECT
+/**
+ * @brief errno to message offset, sized by the highest code in POSIX_ERRORS
+ */
+static const uint16_t errno_to_msg[] = {
+    POSIX_ERRORS(POSIX_ERROR_OFFSET)
 };
 
 const char* contract_strerror(int err) {
-    if (err < 0 || err >= 132 || errno_to_msg[err] == NULL) {
+    if (err < 0 || err >= (int)ERRNO_LIMIT) {
+        return "undefined";
+    }
+    return (const char *)&error_strings + errno_to_msg[err];
+}
+
+#else
+/**
+ * @brief Dense message index of each POSIX_ERRORS entry in list order, 0 is "undefined"
+ */
+enum {
+    error_index_undefined,
+    POSIX_ERRORS(POSIX_ERROR_INDEX)
+    error_count
+};
+
+// uint8_t codes and indices
+typedef char error_index_fit_uint8[error_count <= 0x100 ? 1 : -1];
+
+/**
+ * @brief Message offset by dense index
+ */
+static const uint16_t index_to_msg[error_count] = {
+    [error_index_undefined] = 0,
+    POSIX_ERRORS(POSIX_ERROR_DENSE_OFFSET)
+};
+
+#if CONTRACT_ERRNO_TABLE == CONTRACT_ERRNO_DENSE
+/**
+ * @brief errno to dense message index, sized by the highest code in POSIX_ERRORS
+ */
+static const uint8_t errno_to_msg[] = {
+    POSIX_ERRORS(POSIX_ERROR_DENSE)
+};
+
+const char* contract_strerror(int err) {
+    if (err < 0 || err >= (int)ERRNO_LIMIT) {
+        return "undefined";
+    }
+    return (const char *)&error_strings + index_to_msg[errno_to_msg[err]];
+}
+
+#else
+/**
+ * @brief Every code of POSIX_ERRORS in list order, the position of a code plus one is its dense index
+ */
+static const unsigned char error_codes[error_count - 1] = {
+    POSIX_ERRORS(POSIX_ERROR_CODE)
+};
+
+// memchr() is a rep scasb on the 8086 and vectorised by hosted C libraries
+const char* contract_strerror(int err) {
+    const unsigned char *code;
+
+    if (err < 0 || err > 0xFF) {
         return "undefined";
     }
-    return (*errno_to_msg[err] == '\0') ? "undefined" : errno_to_msg[err];
+    code = (const unsigned char *)memchr(error_codes, err, sizeof(error_codes));
+    return (const char *)&error_strings + (code ? index_to_msg[code - error_codes + 1] : 0);
 }
+#endif
+#endif
@@ -0,0 +1,156 @@
+#include "contract_fs.h"
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#if defined(__WATCOMC__) || defined(_MSC_VER)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#ifndef W_OK
+#define W_OK 2
+#endif
+#if !defined(S_ISDIR) && defined(S_IFDIR)
+#define S_ISDIR(m) (((m) & S_IFMT) == S_IFDIR)
+#endif
+#if !defined(S_ISREG) && defined(S_IFREG)
+#define S_ISREG(m) (((m) & S_IFMT) == S_IFREG)
+#endif
+
+typedef struct {
+    unsigned long hash;         // 0 marks an empty slot
+    time_t when;
+    int writable;               // access(W_OK) == 0, -1 until asked
+    contract_stat_t st;
+    char path[CONTRACT_STAT_PATH_MAX];
+} stat_entry_t;
+
+static CONTRACT_THREAD_LOCAL stat_entry_t stat_cache[CONTRACT_STAT_CACHE_SIZE];
+
+// FNV-1a, never 0, with the length of path
+static unsigned long stat_hash(const char *path, size_t *len) {
+    unsigned long h = 2166136261UL;
+    const char *p;
+
+    for (p = path; *p; p++) h = (h ^ (unsigned char)*p) * 16777619UL;
+    *len = (size_t)(p - path);
+    return h ? h : 1;
+}
+
+static void stat_uncached(const char *path, contract_stat_t *out) {
+    struct stat sb;
+
+    if (stat(path, &sb) != 0) {
+        out->err = errno;
+        out->is_dir = out->is_regular = 0;
+        out->size = 0;
+        return;
+    }
+    out->err = 0;
+    out->is_dir = S_ISDIR(sb.st_mode) ? 1 : 0;
+    out->is_regular = S_ISREG(sb.st_mode) ? 1 : 0;
+    out->size = (long)sb.st_size;
+}
+
+// Entry of path, refreshed when older than the TTL, NULL for paths the cache cannot hold
+static stat_entry_t *stat_lookup(const char *path) {
+    stat_entry_t *e, *victim = NULL, *free_slot = NULL, *oldest = &stat_cache[0];
+    time_t now;
+    size_t len;
+    unsigned long h;
+    int saved = errno;
+
+    if (CONTRACT_STAT_CACHE_TTL <= 0) return NULL;
+    h = stat_hash(path, &len);
+    if (len >= CONTRACT_STAT_PATH_MAX) return NULL;
+    now = time(NULL);
+    for (e = stat_cache; e < stat_cache + CONTRACT_STAT_CACHE_SIZE; e++) {
+        if (e->hash == h && strcmp(e->path, path) == 0) {
+            if (now - e->when < CONTRACT_STAT_CACHE_TTL && now >= e->when) return e;
+            victim = e;
+            break;
+        }
+        // the scan goes on past a free slot, an invalidated entry can leave one before the path's own
+        if (e->hash == 0) {
+            if (!free_slot) free_slot = e;
+        } else if (e->when < oldest->when || oldest->hash == 0) {
+            oldest = e;
+        }
+    }
+    if (!victim) victim = free_slot ? free_slot : oldest;
+    victim->hash = h;
+    victim->when = now;
+    victim->writable = -1;
+    memcpy(victim->path, path, len + 1);
+    stat_uncached(path, &victim->st);
+    errno = saved;      // a contract that holds leaves errno alone
+    return victim;
+}
+
+int contract_stat_cached(const char *path, contract_stat_t *out) {
+    const stat_entry_t *e = stat_lookup(path);
+
+    if (e) *out = e->st;
+    else {
+        int saved = errno;
+
+        stat_uncached(path, out);
+        errno = saved;
+    }
+    return out->err;
+}
+
+void contract_stat_invalidate(const char *path) {
+    stat_entry_t *e;
+    size_t len;
+    unsigned long h;
+
+    if (!path) {
+        memset(stat_cache, 0, sizeof(stat_cache));
+        return;
+    }
+    h = stat_hash(path, &len);
+    for (e = stat_cache; e < stat_cache + CONTRACT_STAT_CACHE_SIZE; e++) {
+        if (e->hash == h && strcmp(e->path, path) == 0) e->hash = 0;
+    }
+}
+
+int contract_path_exists(const char *path) {
+    contract_stat_t st;
+
+    return contract_stat_cached(path, &st) == 0;
+}
+
+int contract_path_is_dir(const char *path) {
+    contract_stat_t st;
+
+    return contract_stat_cached(path, &st) == 0 && st.is_dir;
+}
+
+int contract_path_is_regular(const char *path) {
+    contract_stat_t st;
+
+    return contract_stat_cached(path, &st) == 0 && st.is_regular;
+}
+
+int contract_path_writable(const char *path) {
+    stat_entry_t *e = stat_lookup(path);
+    int saved = errno;
+    int writable;
+
+    if (!e) {
+        writable = access(path, W_OK) == 0;
+    } else {
+        if (e->writable < 0) e->writable = access(path, W_OK) == 0;
+        writable = e->writable;
+    }
+    errno = saved;
+    return writable;
+}
+
+int contract_path_size_at_most(const char *path, long max) {
+    contract_stat_t st;
+
+    return contract_stat_cached(path, &st) == 0 && st.size <= max;
+}
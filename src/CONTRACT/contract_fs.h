@@ -0,0 +1,85 @@
+/**
+ * @file contract_fs.h
+ * @brief Path based filesystem contracts served from a small per thread stat cache
+ * @version 0.1.4
+ * @license MIT
+ * @author Jeremy Thornton
+ */
+#ifndef CONTRACT_FS_H
+#define CONTRACT_FS_H
+
+#include "contract.h"
+
+/**
+ * @brief Paths the cache holds per thread, the least recently refreshed is replaced
+ */
+#ifndef CONTRACT_STAT_CACHE_SIZE
+#define CONTRACT_STAT_CACHE_SIZE 16
+#endif
+
+/**
+ * @brief Longest path cached, in bytes with the terminator, longer ones are always stat()ed
+ */
+#ifndef CONTRACT_STAT_PATH_MAX
+#define CONTRACT_STAT_PATH_MAX 96
+#endif
+
+/**
+ * @brief Seconds a cached result is trusted, 0 disables the cache
+ *
+ * A path the program changes itself should be dropped with contract_stat_invalidate() rather than wait
+ * for the TTL.
+ */
+#ifndef CONTRACT_STAT_CACHE_TTL
+#define CONTRACT_STAT_CACHE_TTL 2
+#endif
+
+/**
+ * @brief What the contracts need of a stat(), cached per path
+ */
+typedef struct {
+    int err;                    /**< 0, or errno of the failed stat() */
+    int is_dir;
+    int is_regular;
+    long size;
+} contract_stat_t;
+
+/**
+ * @brief stat() of path through the cache, failures included
+ *
+ * @param path Path to look up
+ * @param out Receives the result
+ * @return 0, or the errno of stat()
+ */
+int contract_stat_cached(const char *path, contract_stat_t *out);
+
+/**
+ * @brief Drops path from the calling thread's cache, or every path when NULL
+ */
+void contract_stat_invalidate(const char *path);
+
+/**
+ * @brief Cached predicates of the path contracts, 1 if they hold
+ *
+ * contract_path_writable() caches access(path, W_OK) alongside the stat() result.
+ */
+int contract_path_exists(const char *path);
+int contract_path_is_dir(const char *path);
+int contract_path_is_regular(const char *path);
+int contract_path_writable(const char *path);
+int contract_path_size_at_most(const char *path, long max);
+
+// Path based filesystem contracts, repeated checks of a path within CONTRACT_STAT_CACHE_TTL make no system call
+#define require_path_exists(path, msg) _CONTRACT_REQUIRE_FILESYSTEM(contract_path_exists(path), msg, POSIX_ENOENT)  /// @example require_path_exists(config_path, "Config file missing");
+#define require_path_is_dir(path, msg) _CONTRACT_REQUIRE_FILESYSTEM(contract_path_is_dir(path), msg, POSIX_ENOTDIR)
+#define require_path_regular_file(path, msg) _CONTRACT_REQUIRE_FILESYSTEM(contract_path_is_regular(path), msg, POSIX_EINVAL)
+#define require_path_writable(path, msg) _CONTRACT_REQUIRE_FILESYSTEM(contract_path_writable(path), msg, POSIX_EROFS)
+#define require_path_file_size(path, max, msg) _CONTRACT_REQUIRE_FILESYSTEM(contract_path_size_at_most(path, max), msg, POSIX_EFBIG)  /// @example require_path_file_size(upload_path, MAX_UPLOAD, "Upload exceeds size limit");
+
+#define try_require_path_exists(path, msg) _CONTRACT_TRY_REQUIRE_FILESYSTEM(contract_path_exists(path), msg, POSIX_ENOENT)
+#define try_require_path_is_dir(path, msg) _CONTRACT_TRY_REQUIRE_FILESYSTEM(contract_path_is_dir(path), msg, POSIX_ENOTDIR)
+#define try_require_path_regular_file(path, msg) _CONTRACT_TRY_REQUIRE_FILESYSTEM(contract_path_is_regular(path), msg, POSIX_EINVAL)
+#define try_require_path_writable(path, msg) _CONTRACT_TRY_REQUIRE_FILESYSTEM(contract_path_writable(path), msg, POSIX_EROFS)
+#define try_require_path_file_size(path, max, msg) _CONTRACT_TRY_REQUIRE_FILESYSTEM(contract_path_size_at_most(path, max), msg, POSIX_EFBIG)
+
+#endif
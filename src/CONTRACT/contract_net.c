@@ -0,0 +1,267 @@
+#define _DEFAULT_SOURCE     // getifaddrs, IFF_RUNNING, getaddrinfo, pthreads
+
+#include "contract_net.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if CONTRACT_HAVE_THREADS && (defined(__unix__) || defined(__APPLE__))
+#define CONTRACT_HAVE_PROBES 1
+#else
+#define CONTRACT_HAVE_PROBES 0
+#endif
+
+#if CONTRACT_HAVE_PROBES
+#include <pthread.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <ifaddrs.h>
+#include <net/if.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#if defined(__linux__)
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#endif
+
+static pthread_mutex_t probe_lock = PTHREAD_MUTEX_INITIALIZER;
+#define PROBE_LOCK() pthread_mutex_lock(&probe_lock)
+#define PROBE_UNLOCK() pthread_mutex_unlock(&probe_lock)
+#else
+#define PROBE_LOCK() ((void)0)
+#define PROBE_UNLOCK() ((void)0)
+#endif
+
+static contract_probe_t *probes = NULL;
+static unsigned long probe_gen = 0;
+
+static void contract_probe_add(contract_probe_t *probe, const char *name, int is_host, unsigned short port) {
+    probe->status = CONTRACT_PROBE_UNKNOWN;
+    probe->is_host = is_host;
+    strncpy(probe->name, name, sizeof(probe->name) - 1);
+    probe->name[sizeof(probe->name) - 1] = '\0';
+    sprintf(probe->port, "%u", port);
+
+    PROBE_LOCK();
+    probe->gen = ++probe_gen;
+    probe->next = probes;
+    probes = probe;
+    PROBE_UNLOCK();
+}
+
+void contract_probe_interface(contract_probe_t *probe, const char *ifname) {
+    contract_probe_add(probe, ifname, 0, 0);
+}
+
+void contract_probe_host(contract_probe_t *probe, const char *host, unsigned short port) {
+    contract_probe_add(probe, host, 1, port);
+}
+
+void contract_probe_remove(contract_probe_t *probe) {
+    contract_probe_t **p;
+
+    PROBE_LOCK();
+    for (p = &probes; *p; p = &(*p)->next) {
+        if (*p == probe) {
+            *p = probe->next;
+            break;
+        }
+    }
+    probe->next = NULL;
+    PROBE_UNLOCK();
+}
+
+#if CONTRACT_HAVE_PROBES
+
+// One getifaddrs() snapshot serves every interface probe of a pass
+static int probe_interface(const struct ifaddrs *ifs, const char *name) {
+    const struct ifaddrs *i;
+
+    for (i = ifs; i; i = i->ifa_next) {
+        if (strcmp(i->ifa_name, name) == 0) {
+            return (i->ifa_flags & IFF_UP) && (i->ifa_flags & IFF_RUNNING) ? CONTRACT_PROBE_UP : CONTRACT_PROBE_DOWN;
+        }
+    }
+    return CONTRACT_PROBE_DOWN;
+}
+
+// Non-blocking connect to each address of the host, a refusal proves it reachable as well as an accept
+static int probe_host(const char *host, const char *port) {
+    struct addrinfo hints, *res, *ai;
+    struct pollfd pfd;
+    int status = CONTRACT_PROBE_DOWN;
+    int fd, err;
+    socklen_t len;
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    if (getaddrinfo(host, port, &hints, &res) != 0) return CONTRACT_PROBE_DOWN;
+    for (ai = res; ai && status == CONTRACT_PROBE_DOWN; ai = ai->ai_next) {
+        fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (fd < 0) continue;
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+        if (connect(fd, ai->ai_addr, ai->ai_addrlen) == 0) err = 0;
+        else if (errno != EINPROGRESS) err = errno;
+        else {
+            pfd.fd = fd;
+            pfd.events = POLLOUT;
+            err = ETIMEDOUT;
+            len = sizeof(err);
+            if (poll(&pfd, 1, CONTRACT_PROBE_TIMEOUT_MS) == 1 && getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &len) != 0) err = errno;
+        }
+        if (err == 0 || err == ECONNREFUSED) status = CONTRACT_PROBE_UP;
+        close(fd);
+    }
+    freeaddrinfo(res);
+    return status;
+}
+
+// Copy of a registered probe, probed with the lock released
+typedef struct {
+    contract_probe_t *probe;
+    unsigned long gen;
+    int is_host;
+    int status;
+    char name[CONTRACT_PROBE_NAME_MAX];
+    char port[8];
+} probe_copy_t;
+
+unsigned contract_probe_poll(void) {
+    struct ifaddrs *ifs = NULL;
+    probe_copy_t *copy;
+    contract_probe_t *p;
+    unsigned count = 0;
+    unsigned n = 0;
+    unsigned i;
+    int interfaces = 0;
+    int saved = errno;
+
+    PROBE_LOCK();
+    for (p = probes; p; p = p->next) n++;
+    copy = n ? (probe_copy_t *)malloc(n * sizeof(*copy)) : NULL;
+    if (!copy) {
+        PROBE_UNLOCK();
+        return 0;
+    }
+    for (p = probes, i = 0; p; p = p->next, i++) {
+        copy[i].probe = p;
+        copy[i].gen = p->gen;
+        copy[i].is_host = p->is_host;
+        memcpy(copy[i].name, p->name, sizeof(copy[i].name));
+        memcpy(copy[i].port, p->port, sizeof(copy[i].port));
+        interfaces |= !p->is_host;
+    }
+    PROBE_UNLOCK();
+
+    if (interfaces && getifaddrs(&ifs) != 0) ifs = NULL;
+    for (i = 0; i < n; i++) {
+        if (copy[i].is_host) copy[i].status = probe_host(copy[i].name, copy[i].port);
+        else copy[i].status = ifs ? probe_interface(ifs, copy[i].name) : CONTRACT_PROBE_UNKNOWN;
+    }
+    if (ifs) freeifaddrs(ifs);
+
+    // a probe removed during the pass, or removed and registered again, keeps its status
+    PROBE_LOCK();
+    for (i = 0; i < n; i++) {
+        if (copy[i].status == CONTRACT_PROBE_UNKNOWN) continue;
+        for (p = probes; p; p = p->next) {
+            if (p == copy[i].probe && p->gen == copy[i].gen) {
+                CONTRACT_ATOMIC_STORE(&p->status, copy[i].status);
+                count++;
+                break;
+            }
+        }
+    }
+    PROBE_UNLOCK();
+    free(copy);
+    errno = saved;
+    return count;
+}
+
+static pthread_t probe_thread;
+static int probe_running = 0;
+static int probe_stop = 0;
+static unsigned probe_period_ms = 0;
+
+// Link change notifications, -1 where there are none and the period alone paces the prober
+static int probe_link_socket(void) {
+#if defined(__linux__)
+    struct sockaddr_nl addr;
+    int fd = socket(AF_NETLINK, SOCK_RAW, NETLINK_ROUTE);
+
+    if (fd < 0) return -1;
+    memset(&addr, 0, sizeof(addr));
+    addr.nl_family = AF_NETLINK;
+    addr.nl_groups = RTMGRP_LINK;
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+    return fd;
+#else
+    return -1;
+#endif
+}
+
+static void *contract_probe_main(void *arg) {
+    struct pollfd pfd;
+    char buf[4096];
+    int elapsed, slice;
+
+    (void)arg;
+    pfd.fd = probe_link_socket();
+    pfd.events = POLLIN;
+    while (!CONTRACT_ATOMIC_LOAD(&probe_stop)) {
+        contract_probe_poll();
+        // wait out the period in slices short enough for contract_probe_stop() to be prompt
+        for (elapsed = 0; elapsed < (int)probe_period_ms && !CONTRACT_ATOMIC_LOAD(&probe_stop); elapsed += slice) {
+            slice = (int)probe_period_ms - elapsed < 100 ? (int)probe_period_ms - elapsed : 100;
+            if (poll(&pfd, 1, slice) > 0) {
+                while (recv(pfd.fd, buf, sizeof(buf), 0) > 0) continue;
+                break;
+            }
+        }
+    }
+    if (pfd.fd >= 0) close(pfd.fd);
+    return NULL;
+}
+
+posix_error_t contract_probe_start(unsigned period_ms) {
+    int rc;
+
+    if (period_ms == 0) return POSIX_EINVAL;    // the prober would never rest between passes
+    if (probe_running) return POSIX_EALREADY;
+    probe_period_ms = period_ms;
+    CONTRACT_ATOMIC_STORE(&probe_stop, 0);
+    rc = pthread_create(&probe_thread, NULL, contract_probe_main, NULL);
+    if (rc != 0) return (posix_error_t)rc;
+    probe_running = 1;
+    return POSIX_SUCCESS;
+}
+
+void contract_probe_stop(void) {
+    if (probe_running) {
+        CONTRACT_ATOMIC_STORE(&probe_stop, 1);
+        pthread_join(probe_thread, NULL);
+        probe_running = 0;
+    }
+}
+
+#else
+
+unsigned contract_probe_poll(void) {
+    return 0;
+}
+
+posix_error_t contract_probe_start(unsigned period_ms) {
+    (void)period_ms;
+    return POSIX_ENOTSUP;
+}
+
+void contract_probe_stop(void) {
+}
+
+#endif
@@ -0,0 +1,117 @@
+/**
+ * @file contract_net.h
+ * @brief Network state probed in the background, so the network contracts read a status word instead of blocking
+ * @version 0.1.4
+ * @license MIT
+ * @author Jeremy Thornton
+ */
+#ifndef CONTRACT_NET_H
+#define CONTRACT_NET_H
+
+#include "contract.h"
+#include "contract_atomic.h"
+
+/**
+ * @brief Longest interface or host name of a probe, in bytes with the terminator
+ */
+#ifndef CONTRACT_PROBE_NAME_MAX
+#define CONTRACT_PROBE_NAME_MAX 64
+#endif
+
+/**
+ * @brief Milliseconds a host probe waits for its TCP connect to be answered
+ */
+#ifndef CONTRACT_PROBE_TIMEOUT_MS
+#define CONTRACT_PROBE_TIMEOUT_MS 1000
+#endif
+
+enum {
+    CONTRACT_PROBE_UNKNOWN = -1,    /**< Not probed yet, or probing is unsupported */
+    CONTRACT_PROBE_DOWN = 0,
+    CONTRACT_PROBE_UP = 1
+};
+
+/**
+ * @brief Probe of an interface or host, owned by the caller, its status written by the prober
+ */
+typedef struct contract_probe {
+    int status;                 /**< CONTRACT_PROBE_*, read with contract_probe_status() */
+    int is_host;
+    char name[CONTRACT_PROBE_NAME_MAX];
+    char port[8];
+    unsigned long gen;          /**< Registration serial, tells a pass in progress the probe was removed */
+    struct contract_probe *next;
+} contract_probe_t;
+
+/**
+ * @brief Registers a probe of a network interface, up while it is IFF_UP and IFF_RUNNING
+ *
+ * @param probe Probe, must stay valid until contract_probe_remove()
+ * @param ifname Interface name, e.g. "eth0"
+ */
+void contract_probe_interface(contract_probe_t *probe, const char *ifname);
+
+/**
+ * @brief Registers a probe of a host, up while a TCP connect to host:port is answered, refused included
+ *
+ * @param probe Probe, must stay valid until contract_probe_remove()
+ * @param host Host name or address
+ * @param port TCP port connected to
+ */
+void contract_probe_host(contract_probe_t *probe, const char *host, unsigned short port);
+
+/**
+ * @brief Unregisters a probe, never waiting for a probing pass in progress
+ *
+ * A pass probes a copy of the list taken under a short lock, and drops the results of probes removed or
+ * registered again meanwhile, so the probe may be freed as soon as this returns.
+ */
+void contract_probe_remove(contract_probe_t *probe);
+
+/**
+ * @brief Probes everything registered once, on the calling thread
+ *
+ * Host probes block for up to CONTRACT_PROBE_TIMEOUT_MS each, so call it from the application's own
+ * loop only where there is no contract_probe_start(). No lock is held while probing, registering and
+ * removing probes on other threads do not wait for it.
+ *
+ * @return Number of probes updated, 0 where probing is unsupported
+ */
+unsigned contract_probe_poll(void);
+
+/**
+ * @brief Starts the background prober, repeating contract_probe_poll() every period_ms
+ *
+ * On Linux a netlink socket also wakes it as soon as a link changes state.
+ *
+ * @param period_ms Milliseconds between passes, at least 1
+ * @return POSIX_SUCCESS, POSIX_EINVAL for a period of 0, POSIX_EALREADY if running, POSIX_ENOTSUP without threads and sockets, or the
+ *         error of pthread_create()
+ */
+posix_error_t contract_probe_start(unsigned period_ms);
+
+/**
+ * @brief Stops the background prober, after the pass it is running
+ */
+void contract_probe_stop(void);
+
+/**
+ * @brief Last probed status, one atomic load
+ */
+CONTRACT_INLINE int contract_probe_status(const contract_probe_t *probe) {
+    return CONTRACT_ATOMIC_LOAD(&probe->status);
+}
+
+/**
+ * @brief Condition for require_network_up() and require_host_reachable(), 1 unless the probe found it down
+ *
+ * A probe not answered yet counts as up, the contract only fails on evidence:
+ *
+ *     require_network_up(contract_probe_ok(&eth0), "Network interface down");
+ *     require_host_reachable(contract_probe_ok(&db), "Database host unreachable");
+ */
+CONTRACT_INLINE int contract_probe_ok(const contract_probe_t *probe) {
+    return contract_probe_status(probe) != CONTRACT_PROBE_DOWN;
+}
+
+#endif
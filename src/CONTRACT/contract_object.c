@@ -0,0 +1,74 @@
+#define _POSIX_C_SOURCE 200112L   // pthreads
+
+#include "contract_object.h"
+
+#if CONTRACT_HAVE_THREADS
+#include <pthread.h>
+
+static pthread_mutex_t registry_lock = PTHREAD_MUTEX_INITIALIZER;
+#define REGISTRY_LOCK() pthread_mutex_lock(&registry_lock)
+#define REGISTRY_UNLOCK() pthread_mutex_unlock(&registry_lock)
+#else
+#define REGISTRY_LOCK() ((void)0)
+#define REGISTRY_UNLOCK() ((void)0)
+#endif
+
+// Violations an audit holds on to until it has unlocked the registry, later ones are counted only
+#define CONTRACT_AUDIT_REPORTS 8
+
+static contract_object_t *registry = NULL;
+
+void _contract_object_register(contract_object_t *o, const void *obj, contract_invariant_t check, const char *name, const char *file, int line) {
+    o->obj = obj;
+    o->check = check;
+    o->name = name;
+    o->file = file;
+    o->line = line;
+    o->dirty = 1;
+    o->prev = NULL;
+
+    REGISTRY_LOCK();
+    o->next = registry;
+    if (registry) registry->prev = o;
+    registry = o;
+    REGISTRY_UNLOCK();
+}
+
+void contract_object_unregister(contract_object_t *o) {
+    REGISTRY_LOCK();
+    if (o->prev) o->prev->next = o->next;
+    else if (registry == o) registry = o->next;
+    if (o->next) o->next->prev = o->prev;
+    o->prev = o->next = NULL;
+    REGISTRY_UNLOCK();
+}
+
+int _contract_object_check(contract_object_t *o) {
+    CONTRACT_ATOMIC_STORE(&o->dirty, 0);
+    if (o->check(o->obj)) return 1;
+    CONTRACT_ATOMIC_STORE(&o->dirty, 1);
+    return 0;
+}
+
+unsigned long contract_object_audit(void) {
+    const contract_object_t *failed[CONTRACT_AUDIT_REPORTS];
+    contract_object_t report[CONTRACT_AUDIT_REPORTS];
+    contract_object_t *o;
+    unsigned long count = 0;
+    unsigned i, n = 0;
+
+    REGISTRY_LOCK();
+    for (o = registry; o; o = o->next) {
+        if (!CONTRACT_ATOMIC_LOAD(&o->dirty) || _contract_object_check(o)) continue;
+        if (n < CONTRACT_AUDIT_REPORTS) failed[n++] = o;
+        count++;
+    }
+    // copies, an entry may be unregistered as soon as the lock is released
+    for (i = 0; i < n; i++) report[i] = *failed[i];
+    REGISTRY_UNLOCK();
+
+    for (i = 0; i < n; i++) {
+        (void)_contract_fail_at(report[i].name, "Object invariant violated", report[i].file, report[i].line, POSIX_EINVAL);
+    }
+    return count;
+}
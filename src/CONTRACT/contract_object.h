@@ -0,0 +1,102 @@
+/**
+ * @file contract_object.h
+ * @brief Registry of object invariants, checked only when a mutation has marked the object dirty
+ * @version 0.1.4
+ * @license MIT
+ * @author Jeremy Thornton
+ */
+#ifndef CONTRACT_OBJECT_H
+#define CONTRACT_OBJECT_H
+
+#include "contract.h"
+#include "contract_atomic.h"
+
+/**
+ * @brief Full invariant of an object, 1 if it holds
+ *
+ * Typically an O(n) walk of a hash table, arena or ring buffer that is too slow for every call.
+ */
+typedef int (*contract_invariant_t)(const void *obj);
+
+/**
+ * @brief Registry entry of one object, embedded in it or kept alongside, owned by the caller
+ */
+typedef struct contract_object {
+    const void *obj;
+    contract_invariant_t check;
+    const char *name;           /**< Checker named in reports, NULL with CONTRACT_STRIP_TEXT */
+    const char *file;           /**< Registration site, reported by contract_object_audit() */
+    int line;
+    int dirty;                  /**< Mutated since the last full check */
+    struct contract_object *prev;
+    struct contract_object *next;
+} contract_object_t;
+
+/**
+ * @brief Adds an object to the registry, dirty so its first boundary check runs the checker
+ *
+ * @param o Entry, must stay valid until contract_object_unregister()
+ * @param obj Object handed to check
+ * @param check Full invariant of the object
+ */
+#define contract_object_register(o, obj, check) \
+    _contract_object_register(o, obj, check, _CONTRACT_TEXT(#check), CONTRACT_FILE, __LINE__)  /// @example contract_object_register(&table->inv, table, table_invariant);
+
+void _contract_object_register(contract_object_t *o, const void *obj, contract_invariant_t check, const char *name, const char *file, int line);
+
+/**
+ * @brief Removes an object from the registry, waiting for an audit in progress to finish with it
+ */
+void contract_object_unregister(contract_object_t *o);
+
+/**
+ * @brief Runs the checker of every dirty object in the registry and clears their dirty flags
+ *
+ * For periodic use from the application's loop or a background audit. Each violation is reported
+ * through the handler after the registry is unlocked, at the object's registration site. The checkers
+ * run on the calling thread, so objects another thread mutates may only be registered if their
+ * checker takes the object's own lock.
+ *
+ * @return Number of objects found violating their invariant
+ */
+unsigned long contract_object_audit(void);
+
+/**
+ * @brief Clears the dirty flag and runs the checker, out of line
+ *
+ * The flag is cleared first, so a mutation during the check marks the object again. A failed check sets
+ * it again too, a corrupt object keeps failing until a check passes.
+ */
+int _contract_object_check(contract_object_t *o);
+
+CONTRACT_INLINE int _contract_object_ok(contract_object_t *o) {
+    return !CONTRACT_ATOMIC_LOAD(&o->dirty) || _contract_object_check(o);
+}
+
+/**
+ * @brief invariant_object() checks an object at a public API boundary, contract_mark_dirty() after a mutation
+ *
+ *     void table_put(table_t *t, const char *key, int value) {
+ *         invariant_object(&t->inv, "Hash table corrupt");
+ *         ...
+ *         contract_mark_dirty(&t->inv);
+ *     }
+ *
+ * A clean object costs one load and branch, so checking cost follows the mutation rate rather than the
+ * call rate. Both follow CONTRACT_LEVEL_INVARIANT and compile out below it, the checker is opaque to
+ * the optimizer and so never assumed.
+ *
+ * @param o Registered contract_object_t of the object
+ * @param msg Custom error message to display if contract is violated, must be a string literal
+ */
+#if CONTRACT_LEVEL >= CONTRACT_LEVEL_INVARIANT
+#define _CONTRACT_INVARIANT_OBJECT(o, msg, err) _CONTRACT_INVARIANT(_contract_object_ok(o), msg, err)
+#define contract_mark_dirty(o) CONTRACT_ATOMIC_STORE(&(o)->dirty, 1)
+#else
+#define _CONTRACT_INVARIANT_OBJECT(o, msg, err) _CONTRACT_DISABLED(_contract_object_ok(o), msg, err)
+#define contract_mark_dirty(o) ((void)sizeof((o)->dirty))
+#endif
+
+#define invariant_object(o, msg) _CONTRACT_INVARIANT_OBJECT(o, msg, POSIX_EINVAL)
+
+#endif
@@ -0,0 +1,7 @@
+#include "contract_old.h"
+
+CONTRACT_THREAD_LOCAL contract_old_ring_t _contract_old;
+
+void _contract_old_lost(const char *file, int line) {
+    (void)_contract_fail_at("contract_old()", "Old value overwritten, raise CONTRACT_OLD_MAX", file, line, POSIX_ENOMEM);
+}
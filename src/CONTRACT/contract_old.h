@@ -0,0 +1,152 @@
+/**
+ * @file contract_old.h
+ * @brief Old values for postconditions, scalars captured at entry into a small per thread stack
+ * @version 0.1.4
+ * @license MIT
+ * @author Jeremy Thornton
+ */
+#ifndef CONTRACT_OLD_H
+#define CONTRACT_OLD_H
+
+#include "contract.h"
+
+/**
+ * @brief Slots of the per thread stack of old values, a power of two
+ *
+ * With CONTRACT_HAVE_CLEANUP a capture is released when its block is left, taking any the functions it
+ * called left behind with it, so only captures live at the same time compete for slots: a loop calling
+ * a function that captures does not evict the caller's values. A read of a value overwritten by more
+ * than CONTRACT_OLD_MAX live captures, or by a longjmp() out of frames that skipped their release, is
+ * reported through the handler as POSIX_ENOMEM.
+ *
+ * Without CONTRACT_HAVE_CLEANUP (Open Watcom) nothing is released and the stack wraps as a ring, each
+ * capture then holds its slot for CONTRACT_OLD_MAX later captures on the same thread.
+ */
+#ifndef CONTRACT_OLD_MAX
+#define CONTRACT_OLD_MAX 16
+#endif
+
+#if CONTRACT_OLD_MAX & (CONTRACT_OLD_MAX - 1)
+#error "CONTRACT_OLD_MAX must be a power of two"
+#endif
+
+typedef union {
+    long l;
+    unsigned long u;
+    double d;
+    const void *p;
+} contract_old_value_t;
+
+typedef struct {
+    contract_old_value_t value;
+    unsigned owner;                                 /**< Handle of the capture that wrote the slot */
+} contract_old_slot_t;
+
+typedef struct {
+    unsigned head;                                  /**< Handle of the next capture, wraps */
+    contract_old_slot_t slot[CONTRACT_OLD_MAX];
+} contract_old_ring_t;
+
+extern CONTRACT_THREAD_LOCAL contract_old_ring_t _contract_old;
+
+/**
+ * @brief Reports the read of an old value overwritten by later captures, out of line
+ */
+CONTRACT_COLD void _contract_old_lost(const char *file, int line);
+
+CONTRACT_INLINE contract_old_slot_t *_contract_old_take(void) {
+    contract_old_slot_t *slot = &_contract_old.slot[_contract_old.head & (CONTRACT_OLD_MAX - 1)];
+
+    slot->owner = _contract_old.head++;
+    return slot;
+}
+
+// Captures, each returns the handle of its slot
+CONTRACT_INLINE unsigned _contract_old_put_l(long v) {
+    contract_old_slot_t *slot = _contract_old_take();
+
+    slot->value.l = v;
+    return slot->owner;
+}
+
+CONTRACT_INLINE unsigned _contract_old_put_u(unsigned long v) {
+    contract_old_slot_t *slot = _contract_old_take();
+
+    slot->value.u = v;
+    return slot->owner;
+}
+
+CONTRACT_INLINE unsigned _contract_old_put_d(double v) {
+    contract_old_slot_t *slot = _contract_old_take();
+
+    slot->value.d = v;
+    return slot->owner;
+}
+
+CONTRACT_INLINE unsigned _contract_old_put_p(const void *v) {
+    contract_old_slot_t *slot = _contract_old_take();
+
+    slot->value.p = v;
+    return slot->owner;
+}
+
+// Block exit of a capture, pops it and every capture taken after it
+CONTRACT_INLINE void _contract_old_release(const unsigned *handle) {
+    _contract_old.head = *handle;
+}
+
+CONTRACT_INLINE const contract_old_value_t *_contract_old_at(unsigned handle, const char *file, int line) {
+    const contract_old_slot_t *slot = &_contract_old.slot[handle & (CONTRACT_OLD_MAX - 1)];
+
+    if (CONTRACT_UNLIKELY(slot->owner != handle)) _contract_old_lost(file, line);
+    return &slot->value;
+}
+
+/**
+ * @brief ensure_old() captures the value of expr on entry, contract_old() reads it back in a postcondition
+ *
+ *     void account_debit(account_t *acct, long amount) {
+ *         ensure_old(balance, acct->balance);
+ *         ...
+ *         ensure_in_range(acct->balance, contract_old(balance) - amount, contract_old(balance), "Debit out of step");
+ *     }
+ *
+ * Only the scalar is stored, as a long, or unsigned long, double or pointer with the suffixed forms,
+ * in place of a copy of the whole object; the handle on the stack is an unsigned, released with the
+ * block. The name is local to the block, so one function can capture several.
+ *
+ * Below CONTRACT_LEVEL_ENSURE expr is not evaluated and nothing is stored, contract_old() is then a zero
+ * of the captured type for the compiled out ensures to type check. Within CONTRACT_ASSUME_LEVEL the
+ * capture is a local variable instead, so the assumed postconditions compare against the real value,
+ * an optimizer reading them drops it again.
+ *
+ * @param name Identifier of the capture, passed to contract_old()
+ * @param expr Value to capture
+ */
+#if CONTRACT_LEVEL >= CONTRACT_LEVEL_ENSURE
+#if CONTRACT_HAVE_CLEANUP
+#define _CONTRACT_OLD_HANDLE __attribute__((cleanup(_contract_old_release))) const unsigned
+#else
+#define _CONTRACT_OLD_HANDLE const unsigned
+#endif
+#define _CONTRACT_OLD(name, type, kind, expr) \
+    typedef type _contract_old_type_##name; \
+    _CONTRACT_OLD_HANDLE _contract_old_handle_##name = _contract_old_put_##kind(expr)
+#define contract_old(name) \
+    (*(const _contract_old_type_##name *)_contract_old_at(_contract_old_handle_##name, CONTRACT_FILE, __LINE__))
+#elif CONTRACT_HAVE_ASSUME && CONTRACT_ASSUME_LEVEL >= CONTRACT_LEVEL_ENSURE
+#define _CONTRACT_OLD(name, type, kind, expr) const type _contract_old_value_##name = (expr)
+#define contract_old(name) (_contract_old_value_##name)
+#else
+#define _CONTRACT_OLD(name, type, kind, expr) \
+    typedef type _contract_old_type_##name; \
+    (void)sizeof((type)(expr))
+#define contract_old(name) ((_contract_old_type_##name)0)
+#endif
+
+#define ensure_old(name, expr) _CONTRACT_OLD(name, long, l, expr)  /// @example ensure_old(balance, acct->balance);
+#define ensure_old_unsigned(name, expr) _CONTRACT_OLD(name, unsigned long, u, expr)
+#define ensure_old_double(name, expr) _CONTRACT_OLD(name, double, d, expr)
+#define ensure_old_ptr(name, expr) _CONTRACT_OLD(name, const void *, p, expr)
+
+#endif
@@ -0,0 +1,136 @@
+/**
+ * @file contract_overflow.h
+ * @brief Overflow checked integer arithmetic and the contracts guarding it
+ * @version 0.1.4
+ * @license MIT
+ * @author Jeremy Thornton
+ */
+#ifndef CONTRACT_OVERFLOW_H
+#define CONTRACT_OVERFLOW_H
+
+#include "contract.h"
+
+/**
+ * @brief CONTRACT_HAVE_OVERFLOW_BUILTINS is 1 where __builtin_add/sub/mul_overflow are available
+ *
+ * They compile to the operation and a branch on the carry or overflow flag. Elsewhere, Open Watcom in
+ * particular, the operations test their operands against the limits first, and multiplication divides.
+ */
+#ifndef CONTRACT_HAVE_OVERFLOW_BUILTINS
+#if defined(__has_builtin)
+#if __has_builtin(__builtin_add_overflow) && __has_builtin(__builtin_sub_overflow) && __has_builtin(__builtin_mul_overflow)
+#define CONTRACT_HAVE_OVERFLOW_BUILTINS 1
+#endif
+#elif defined(__GNUC__) && __GNUC__ >= 5
+#define CONTRACT_HAVE_OVERFLOW_BUILTINS 1
+#endif
+#endif
+#ifndef CONTRACT_HAVE_OVERFLOW_BUILTINS
+#define CONTRACT_HAVE_OVERFLOW_BUILTINS 0
+#endif
+
+/**
+ * @brief Checked a + b, a - b and a * b
+ *
+ * The result is stored in *out in every case, wrapped modulo the width of the type on overflow, so
+ * the contracts below still compute it when compiled out.
+ *
+ * @param a First operand
+ * @param b Second operand
+ * @param out Receives the result
+ * @return 1 if the exact result fits the type, 0 on overflow
+ */
+#if CONTRACT_HAVE_OVERFLOW_BUILTINS
+#define _CONTRACT_OVERFLOW_OPS(suffix, type, utype, min, max) \
+    CONTRACT_INLINE int contract_add_ok##suffix(type a, type b, type *out) { return !__builtin_add_overflow(a, b, out); } \
+    CONTRACT_INLINE int contract_sub_ok##suffix(type a, type b, type *out) { return !__builtin_sub_overflow(a, b, out); } \
+    CONTRACT_INLINE int contract_mul_ok##suffix(type a, type b, type *out) { return !__builtin_mul_overflow(a, b, out); }
+#else
+#define _CONTRACT_OVERFLOW_OPS(suffix, type, utype, min, max) \
+    CONTRACT_INLINE int contract_add_ok##suffix(type a, type b, type *out) { \
+        *out = (type)((utype)a + (utype)b); \
+        return b >= 0 ? a <= max - b : a >= min - b; \
+    } \
+    CONTRACT_INLINE int contract_sub_ok##suffix(type a, type b, type *out) { \
+        *out = (type)((utype)a - (utype)b); \
+        return b >= 0 ? a >= min + b : a <= max + b; \
+    } \
+    CONTRACT_INLINE int contract_mul_ok##suffix(type a, type b, type *out) { \
+        *out = (type)((utype)a * (utype)b); \
+        if (a > 0) return b > 0 ? a <= max / b : b >= min / a; \
+        return b > 0 ? a >= min / b : a == 0 || b >= max / a; \
+    }
+#endif
+
+_CONTRACT_OVERFLOW_OPS(, int, unsigned, INT_MIN, INT_MAX)
+_CONTRACT_OVERFLOW_OPS(_long, long, unsigned long, LONG_MIN, LONG_MAX)
+
+// size_t, for allocation sizes, subtraction fails when b exceeds a
+#if CONTRACT_HAVE_OVERFLOW_BUILTINS
+CONTRACT_INLINE int contract_add_ok_size(size_t a, size_t b, size_t *out) { return !__builtin_add_overflow(a, b, out); }
+CONTRACT_INLINE int contract_sub_ok_size(size_t a, size_t b, size_t *out) { return !__builtin_sub_overflow(a, b, out); }
+CONTRACT_INLINE int contract_mul_ok_size(size_t a, size_t b, size_t *out) { return !__builtin_mul_overflow(a, b, out); }
+#else
+CONTRACT_INLINE int contract_add_ok_size(size_t a, size_t b, size_t *out) {
+    *out = a + b;
+    return *out >= a;
+}
+
+CONTRACT_INLINE int contract_sub_ok_size(size_t a, size_t b, size_t *out) {
+    *out = a - b;
+    return b <= a;
+}
+
+CONTRACT_INLINE int contract_mul_ok_size(size_t a, size_t b, size_t *out) {
+    *out = a * b;
+    return a == 0 || *out / a == b;
+}
+#endif
+
+/**
+ * @brief Selectors of the arithmetic contracts, which unlike other contracts must always evaluate
+ *
+ * The operation is the condition, so a compiled out contract still performs it, unchecked, and within
+ * CONTRACT_ASSUME_LEVEL lets the optimizer assume it did not overflow. They are never sampled either,
+ * since every pass needs its result.
+ */
+#if CONTRACT_ENABLE_MATH && CONTRACT_LEVEL >= CONTRACT_LEVEL_REQUIRE
+#define _CONTRACT_REQUIRE_ARITH(op, msg) _CONTRACT_ENFORCE(op, msg, POSIX_EOVERFLOW)
+#define _CONTRACT_TRY_REQUIRE_ARITH(op, msg) _CONTRACT_CHECK(op, msg, POSIX_EOVERFLOW)
+#elif CONTRACT_HAVE_ASSUME && CONTRACT_ASSUME_LEVEL >= CONTRACT_LEVEL_REQUIRE
+#define _CONTRACT_REQUIRE_ARITH(op, msg) \
+    do { \
+        int _contract_fits = (op); \
+        CONTRACT_ASSUME(_contract_fits); \
+    } while (0)
+#define _CONTRACT_TRY_REQUIRE_ARITH(op, msg) ((void)(op), POSIX_SUCCESS)
+#else
+#define _CONTRACT_REQUIRE_ARITH(op, msg) \
+    do { \
+        (void)(op); \
+    } while (0)
+#define _CONTRACT_TRY_REQUIRE_ARITH(op, msg) ((void)(op), POSIX_SUCCESS)
+#endif
+
+// Arithmetic contracts, out receives the result, POSIX_EOVERFLOW when it does not fit
+#define require_add_ok(a, b, out, msg) _CONTRACT_REQUIRE_ARITH(contract_add_ok(a, b, out), msg)  /// @example require_add_ok(offset, len, &end, "Offset past INT_MAX");
+#define require_sub_ok(a, b, out, msg) _CONTRACT_REQUIRE_ARITH(contract_sub_ok(a, b, out), msg)
+#define require_mul_ok(a, b, out, msg) _CONTRACT_REQUIRE_ARITH(contract_mul_ok(a, b, out), msg)
+#define require_add_ok_long(a, b, out, msg) _CONTRACT_REQUIRE_ARITH(contract_add_ok_long(a, b, out), msg)
+#define require_sub_ok_long(a, b, out, msg) _CONTRACT_REQUIRE_ARITH(contract_sub_ok_long(a, b, out), msg)
+#define require_mul_ok_long(a, b, out, msg) _CONTRACT_REQUIRE_ARITH(contract_mul_ok_long(a, b, out), msg)
+#define require_add_ok_size(a, b, out, msg) _CONTRACT_REQUIRE_ARITH(contract_add_ok_size(a, b, out), msg)  /// @example require_add_ok_size(sizeof(header_t), payload, &total, "Packet size overflow");
+#define require_sub_ok_size(a, b, out, msg) _CONTRACT_REQUIRE_ARITH(contract_sub_ok_size(a, b, out), msg)
+#define require_mul_ok_size(a, b, out, msg) _CONTRACT_REQUIRE_ARITH(contract_mul_ok_size(a, b, out), msg)  /// @example require_mul_ok_size(count, sizeof(item_t), &bytes, "Array size overflow"); p = malloc(bytes);
+
+#define try_require_add_ok(a, b, out, msg) _CONTRACT_TRY_REQUIRE_ARITH(contract_add_ok(a, b, out), msg)
+#define try_require_sub_ok(a, b, out, msg) _CONTRACT_TRY_REQUIRE_ARITH(contract_sub_ok(a, b, out), msg)
+#define try_require_mul_ok(a, b, out, msg) _CONTRACT_TRY_REQUIRE_ARITH(contract_mul_ok(a, b, out), msg)
+#define try_require_add_ok_long(a, b, out, msg) _CONTRACT_TRY_REQUIRE_ARITH(contract_add_ok_long(a, b, out), msg)
+#define try_require_sub_ok_long(a, b, out, msg) _CONTRACT_TRY_REQUIRE_ARITH(contract_sub_ok_long(a, b, out), msg)
+#define try_require_mul_ok_long(a, b, out, msg) _CONTRACT_TRY_REQUIRE_ARITH(contract_mul_ok_long(a, b, out), msg)
+#define try_require_add_ok_size(a, b, out, msg) _CONTRACT_TRY_REQUIRE_ARITH(contract_add_ok_size(a, b, out), msg)
+#define try_require_sub_ok_size(a, b, out, msg) _CONTRACT_TRY_REQUIRE_ARITH(contract_sub_ok_size(a, b, out), msg)
+#define try_require_mul_ok_size(a, b, out, msg) _CONTRACT_TRY_REQUIRE_ARITH(contract_mul_ok_size(a, b, out), msg)
+
+#endif
@@ -0,0 +1,99 @@
+#include "contract_profile.h"
+#include "contract_atomic.h"
+#if CONTRACT_COVERAGE
+#include "contract_coverage.h"
+#endif
+#include <stdlib.h>
+
+static contract_profile_t *profile_list = NULL;
+
+void _contract_profile_add(contract_profile_t *prof, const contract_site_t *site, contract_ticks_t ticks) {
+    const contract_site_t *unset = NULL;
+    contract_profile_t *head;
+
+    CONTRACT_ATOMIC_FETCH_ADD(&prof->evals, 1);
+    if (ticks) CONTRACT_ATOMIC_FETCH_ADD(&prof->ticks, ticks);
+    if (CONTRACT_LIKELY(CONTRACT_ATOMIC_LOAD(&prof->site) != NULL)) return;
+    if (!CONTRACT_ATOMIC_CAS(&prof->site, &unset, site)) return;
+
+    // first evaluation of this site, push it onto the list
+    head = CONTRACT_ATOMIC_LOAD(&profile_list);
+    do {
+        prof->next = head;
+    } while (!CONTRACT_ATOMIC_CAS(&profile_list, &head, prof));
+#if CONTRACT_COVERAGE
+    _contract_coverage_arm();
+#endif
+}
+
+void contract_profile_foreach(void (*fn)(const contract_profile_t *prof, void *ctx), void *ctx) {
+    contract_profile_t *prof;
+
+    for (prof = CONTRACT_ATOMIC_LOAD(&profile_list); prof; prof = prof->next) {
+        fn(prof, ctx);
+    }
+}
+
+void contract_profile_reset(void) {
+    contract_profile_t *prof;
+
+    for (prof = CONTRACT_ATOMIC_LOAD(&profile_list); prof; prof = prof->next) {
+        CONTRACT_ATOMIC_STORE(&prof->ticks, 0);
+        CONTRACT_ATOMIC_STORE(&prof->evals, 0);
+    }
+}
+
+static int compare_cost(const void *a, const void *b) {
+    const contract_profile_t *pa = *(const contract_profile_t * const *)a;
+    const contract_profile_t *pb = *(const contract_profile_t * const *)b;
+    contract_ticks_t ca = CONTRACT_PROFILE_CYCLES ? pa->ticks : pa->evals;
+    contract_ticks_t cb = CONTRACT_PROFILE_CYCLES ? pb->ticks : pb->evals;
+
+    return ca > cb ? -1 : ca < cb;
+}
+
+static contract_ticks_t contract_ticks_overhead(void) {
+    contract_ticks_t best = (contract_ticks_t)-1;
+    contract_ticks_t t0;
+    contract_ticks_t t;
+    int i;
+
+    for (i = 0; i < 64; i++) {
+        t0 = contract_ticks();
+        t = contract_ticks() - t0;
+        if (t < best) best = t;
+    }
+    return best;
+}
+
+unsigned contract_profile_dump(FILE *out) {
+    const contract_profile_t **sorted;
+    const contract_profile_t *prof;
+    unsigned count = 0;
+    unsigned i;
+
+    for (prof = CONTRACT_ATOMIC_LOAD(&profile_list); prof; prof = prof->next) count++;
+    if (!count) return 0;
+    sorted = (const contract_profile_t **)malloc(count * sizeof(*sorted));
+    if (!sorted) return 0;
+
+    // sites registered after the count was taken are left for the next dump
+    i = 0;
+    for (prof = CONTRACT_ATOMIC_LOAD(&profile_list); prof && i < count; prof = prof->next) sorted[i++] = prof;
+    count = i;
+    qsort(sorted, count, sizeof(*sorted), compare_cost);
+
+    fprintf(out, "# contract profile, %u sites, counter overhead %lu ticks/eval\n", count,
+        (unsigned long)contract_ticks_overhead());
+    fprintf(out, "# %14s %14s %10s  site\n", "ticks", "evals", "ticks/eval");
+    for (i = 0; i < count; i++) {
+        prof = sorted[i];
+        fprintf(out, "%16.0f %14.0f %10.1f  %s:%d|", (double)prof->ticks, (double)prof->evals,
+            prof->evals ? (double)prof->ticks / (double)prof->evals : 0.0,
+            prof->site->file, prof->site->line);
+        if (prof->site->cond) fprintf(out, "%s\n", prof->site->cond);
+        else fprintf(out, "#%08lX\n", contract_site_id(prof->site));
+    }
+    free((void *)sorted);
+    return count;
+}
@@ -0,0 +1,44 @@
+/**
+ * @file contract_profile.h
+ * @brief Per site contract evaluation counts and cost, for CONTRACT_PROFILE builds
+ * @version 0.1.4
+ * @license MIT
+ * @author Jeremy Thornton
+ */
+#ifndef CONTRACT_PROFILE_H
+#define CONTRACT_PROFILE_H
+
+#include "contract.h"
+#include <stdio.h>
+
+/**
+ * @brief Calls fn for every site evaluated at least once, most recently registered first
+ *
+ * Without CONTRACT_PROFILE no site is ever registered and fn is never called.
+ * Counters are read without locking while other threads may still be evaluating, treat them as a snapshot.
+ *
+ * @param fn Callback invoked with each site's profile block, prof->site is the site descriptor
+ * @param ctx Caller context handed through to fn
+ */
+void contract_profile_foreach(void (*fn)(const contract_profile_t *prof, void *ctx), void *ctx);
+
+/**
+ * @brief Writes the profile report, one line per site, most expensive first
+ *
+ * Sites are ordered by total ticks, or by evaluations without CONTRACT_PROFILE_CYCLES:
+ *     total ticks  evaluations  ticks/eval  filename:line|condition
+ * contract_ticks() counts TSC cycles on x86, timer ticks on AArch64 and clock() ticks elsewhere,
+ * so compare totals within one report rather than across targets. The per evaluation figure
+ * includes the overhead of reading the counter twice, which the report also states.
+ *
+ * @param out Stream to write the report to
+ * @return Number of sites written, or 0 if there was no memory to sort them
+ */
+unsigned contract_profile_dump(FILE *out);
+
+/**
+ * @brief Zeroes the counters of every registered site, e.g. to skip start-up in the report
+ */
+void contract_profile_reset(void);
+
+#endif
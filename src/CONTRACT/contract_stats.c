@@ -0,0 +1,57 @@
+#include "contract_stats.h"
+#include "contract_atomic.h"
+
+static contract_stats_t *stats_list = NULL;
+static unsigned long rate_burst = CONTRACT_REPORT_BURST;
+static unsigned long rate_period = CONTRACT_REPORT_PERIOD;
+
+void contract_stats_hit(const contract_site_t *site) {
+    contract_stats_t *stats = site->stats;
+    contract_stats_t *head;
+
+    if (!stats) return;
+    if (CONTRACT_ATOMIC_FETCH_ADD(&stats->hits, 1) != 0) return;
+
+    // first violation of this site, push it onto the list
+    stats->site = site;
+    head = CONTRACT_ATOMIC_LOAD(&stats_list);
+    do {
+        stats->next = head;
+    } while (!CONTRACT_ATOMIC_CAS(&stats_list, &head, stats));
+}
+
+int contract_should_report(const contract_site_t *site, unsigned long *suppressed) {
+    contract_stats_t *stats = site->stats;
+    unsigned long now;
+    unsigned long last;
+
+    *suppressed = 0;
+    if (!stats || !rate_period) return 1;
+
+    now = (unsigned long)time(NULL);
+    if (CONTRACT_ATOMIC_FETCH_ADD(&stats->reported, 1) < rate_burst) {
+        CONTRACT_ATOMIC_STORE(&stats->last_report, now);
+        return 1;
+    }
+    last = CONTRACT_ATOMIC_LOAD(&stats->last_report);
+    if (now - last >= rate_period && CONTRACT_ATOMIC_CAS_STRONG(&stats->last_report, &last, now)) {
+        *suppressed = CONTRACT_ATOMIC_EXCHANGE(&stats->suppressed, 0);
+        return 1;
+    }
+    CONTRACT_ATOMIC_FETCH_ADD(&stats->reported, (unsigned long)-1);  // not reported after all
+    CONTRACT_ATOMIC_FETCH_ADD(&stats->suppressed, 1);
+    return 0;
+}
+
+void contract_set_rate_limit(unsigned long burst, unsigned long period) {
+    rate_burst = burst;
+    rate_period = period;
+}
+
+void contract_stats_foreach(void (*fn)(const contract_site_t *site, const contract_stats_t *stats, void *ctx), void *ctx) {
+    contract_stats_t *stats;
+
+    for (stats = CONTRACT_ATOMIC_LOAD(&stats_list); stats; stats = stats->next) {
+        fn(stats->site, stats, ctx);
+    }
+}
@@ -0,0 +1,54 @@
+/**
+ * @file contract_stats.h
+ * @brief Per site contract violation counters and rate limited reporting
+ * @version 0.1.4
+ * @license MIT
+ * @author Jeremy Thornton
+ */
+#ifndef CONTRACT_STATS_H
+#define CONTRACT_STATS_H
+
+#include "contract.h"
+
+/**
+ * @brief Counts one violation of site, called by _contract_fail() before the handler
+ *
+ * The first violation links the site's counter block into the statistics list. Sites without
+ * counters (CONTRACT_STATS 0, or try_* forms on compilers without statement expressions) are ignored.
+ *
+ * @param site Static descriptor of the contract that failed
+ */
+void contract_stats_hit(const contract_site_t *site);
+
+/**
+ * @brief Rate limit for reporting a violation of site
+ *
+ * The first burst violations of each site are reported, after that at most one every period seconds,
+ * the others are counted as suppressed. Sites without counters are always reported.
+ *
+ * @param site Static descriptor of the contract that failed
+ * @param suppressed Set to the number of violations of site suppressed since its last report
+ * @return 1 to report the violation, 0 to suppress it
+ */
+int contract_should_report(const contract_site_t *site, unsigned long *suppressed);
+
+/**
+ * @brief Changes the rate limit, CONTRACT_REPORT_BURST and CONTRACT_REPORT_PERIOD by default
+ *
+ * @param burst Violations per site reported unconditionally, 0 rate limits from the first
+ * @param period Seconds between reports after the burst, 0 disables rate limiting
+ */
+void contract_set_rate_limit(unsigned long burst, unsigned long period);
+
+/**
+ * @brief Calls fn for every site that has failed at least once, most recently registered first
+ *
+ * Counters are read without locking while other threads may still be failing, so treat them as a
+ * snapshot, e.g. for scraping into a metrics system without parsing the logs.
+ *
+ * @param fn Callback invoked with each site and its counters
+ * @param ctx Caller context handed through to fn
+ */
+void contract_stats_foreach(void (*fn)(const contract_site_t *site, const contract_stats_t *stats, void *ctx), void *ctx);
+
+#endif
@@ -0,0 +1,43 @@
+/**
+ * @file contract_ticks.h
+ * @brief Cheap cycle counter used to time contract evaluation
+ * @version 0.1.4
+ * @license MIT
+ * @author Jeremy Thornton
+ */
+#ifndef CONTRACT_TICKS_H
+#define CONTRACT_TICKS_H
+
+#include "contract_config.h"
+#include <time.h>
+
+/**
+ * @brief Tick count type, 64 bit where the compiler has it
+ */
+#if defined(__GNUC__) || defined(__clang__) || defined(_MSC_VER) || (defined(__STDC_VERSION__) && __STDC_VERSION__ >= 199901L)
+typedef unsigned long long contract_ticks_t;
+#else
+typedef unsigned long contract_ticks_t;
+#endif
+
+/**
+ * @brief Reads the tick counter
+ *
+ * - x86 / x86-64 with GCC or Clang: rdtsc, CPU reference cycles
+ * - AArch64 with GCC or Clang: cntvct_el0, the virtual timer count
+ * - elsewhere, Watcom DOS included: clock(), far too coarse to time a single check, so only the
+ *   totals over many evaluations are meaningful there
+ */
+CONTRACT_INLINE contract_ticks_t contract_ticks(void) {
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    return __builtin_ia32_rdtsc();
+#elif (defined(__GNUC__) || defined(__clang__)) && defined(__aarch64__)
+    contract_ticks_t v;
+    __asm__ __volatile__("mrs %0, cntvct_el0" : "=r"(v));
+    return v;
+#else
+    return (contract_ticks_t)clock();
+#endif
+}
+
+#endif
@@ -0,0 +1,331 @@
+#include "contract_utf8.h"
+#include <string.h>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define CONTRACT_UTF8_X86 1
+#elif (defined(__GNUC__) || defined(__clang__)) && defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define CONTRACT_UTF8_NEON 1
+#endif
+
+#ifndef CONTRACT_UTF8_X86
+#define CONTRACT_UTF8_X86 0
+#endif
+#ifndef CONTRACT_UTF8_NEON
+#define CONTRACT_UTF8_NEON 0
+#endif
+
+// Bytes tested per reduction of the vector kernels
+#define CONTRACT_UTF8_BLOCK 64
+
+/*
+ * DFA fallback. Bytes fall into 12 classes, the states track the continuation bytes still owed and
+ * the narrower range the first of them must fall in after E0, ED, F0 and F4.
+ */
+enum {
+    UTF8_ACCEPT = 0,
+    UTF8_REJECT = 1
+};
+
+static const unsigned char utf8_class[256] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,             // 00..7F ASCII
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,             // 80..8F continuation
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,             // 90..9F continuation
+    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,             // A0..BF continuation
+    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+    11, 11, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,           // C0..C1 overlong, C2..DF two byte lead
+    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+    5, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 7, 6, 6,             // E0, E1..EC, ED, EE..EF three byte lead
+    8, 9, 9, 9, 10, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11  // F0, F1..F3, F4 four byte lead, F5..FF
+};
+
+static const unsigned char utf8_state[9][12] = {
+    { 0, 1, 1, 1, 2, 4, 3, 5, 7, 6, 8, 1 },     // accept
+    { 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1 },     // reject
+    { 1, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1 },     // one continuation owed
+    { 1, 2, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1 },     // two owed
+    { 1, 1, 1, 2, 1, 1, 1, 1, 1, 1, 1, 1 },     // after E0, A0..BF then one
+    { 1, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1 },     // after ED, 80..9F then one
+    { 1, 3, 3, 3, 1, 1, 1, 1, 1, 1, 1, 1 },     // three owed
+    { 1, 1, 3, 3, 1, 1, 1, 1, 1, 1, 1, 1 },     // after F0, 90..BF then two
+    { 1, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1 }      // after F4, 80..8F then two
+};
+
+#define CONTRACT_UTF8_HIGH_BITS (((unsigned long)-1 / 0xFF) * 0x80)
+
+// DFA from offset i, which must start a sequence, returns the start of the first ill-formed one or n
+static size_t contract_utf8_scan(const unsigned char *s, size_t i, size_t n) {
+    unsigned state = UTF8_ACCEPT;
+    size_t start = i;
+    unsigned long word;
+
+    while (i < n) {
+        if (state == UTF8_ACCEPT) {
+            while (i + sizeof(word) <= n) {
+                memcpy(&word, s + i, sizeof(word));
+                if (word & CONTRACT_UTF8_HIGH_BITS) break;
+                i += sizeof(word);
+            }
+            if (i >= n) break;
+            start = i;
+            if (s[i] < 0x80) {
+                i++;
+                continue;
+            }
+        }
+        state = utf8_state[state][utf8_class[s[i]]];
+        if (state == UTF8_REJECT) return start;
+        i++;
+    }
+    return state == UTF8_ACCEPT ? n : start;
+}
+
+/*
+ * The vector kernels validate whole blocks and return the offset of the first block with an error,
+ * or where they stopped. The error may lie in a sequence begun up to three bytes earlier, so the
+ * scalar pass resumes from the lead byte that could own it.
+ */
+static size_t contract_utf8_resume(const unsigned char *s, size_t i) {
+    size_t back;
+
+    for (back = 1; back <= 3 && back <= i; back++) {
+        if (s[i - back] >= 0xC0) return i - back;
+        if (s[i - back] < 0x80) break;
+    }
+    return i;
+}
+
+#if CONTRACT_UTF8_X86 || CONTRACT_UTF8_NEON
+/*
+ * Error flags of a byte and its predecessor, the three tables are indexed by the high and low nibble
+ * of the first byte and the high nibble of the second, and a pair is ill-formed when the AND of its
+ * three entries is non-zero. TWO_CONTS is expected where a third or fourth byte is owed, which the
+ * kernels compute from the bytes two and three back.
+ */
+#define TOO_SHORT       0x01    // lead or ASCII, then a lead or ASCII after a lead
+#define TOO_LONG        0x02    // ASCII, then a continuation
+#define OVERLONG_3      0x04    // E0 80..9F
+#define TOO_LARGE       0x08    // F4 90..BF, F5..FF
+#define SURROGATE       0x10    // ED A0..BF
+#define OVERLONG_2      0x20    // C0..C1
+#define TOO_LARGE_1000  0x40    // F5..FF 80..8F
+#define OVERLONG_4      0x40    // F0 80..8F
+#define TWO_CONTS       0x80    // continuation, then a continuation
+#define CARRY           (TOO_SHORT | TOO_LONG | TWO_CONTS)
+
+static const unsigned char utf8_byte1_high[16] = {
+    TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+    TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS,
+    TOO_SHORT | OVERLONG_2,
+    TOO_SHORT,
+    TOO_SHORT | OVERLONG_3 | SURROGATE,
+    TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4
+};
+
+static const unsigned char utf8_byte1_low[16] = {
+    CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4,
+    CARRY | OVERLONG_2,
+    CARRY,
+    CARRY,
+    CARRY | TOO_LARGE,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000
+};
+
+static const unsigned char utf8_byte2_high[16] = {
+    TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4,
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE,
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+    TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT
+};
+
+// Limits of the last three bytes of a block, a greater byte starts a sequence the block does not finish
+static const unsigned char utf8_incomplete[32] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xF0 - 1, 0xE0 - 1, 0xC0 - 1
+};
+#endif
+
+#if CONTRACT_UTF8_X86
+static int contract_utf8_isa(void) {
+    static int isa = -1;    // 2 AVX2, 1 SSSE3, 0 scalar
+
+    if (isa < 0) isa = __builtin_cpu_supports("avx2") ? 2 : __builtin_cpu_supports("ssse3") ? 1 : 0;
+    return isa;
+}
+
+__attribute__((target("ssse3")))
+static __m128i contract_utf8_check_ssse3(__m128i in, __m128i prev) {
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+    __m128i prev1 = _mm_alignr_epi8(in, prev, 15);
+    __m128i high1 = _mm_and_si128(_mm_srli_epi16(prev1, 4), nibble);
+    __m128i sc = _mm_and_si128(
+        _mm_and_si128(_mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)utf8_byte1_high), high1),
+                      _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)utf8_byte1_low), _mm_and_si128(prev1, nibble))),
+        _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)utf8_byte2_high), _mm_and_si128(_mm_srli_epi16(in, 4), nibble)));
+    __m128i third = _mm_subs_epu8(_mm_alignr_epi8(in, prev, 14), _mm_set1_epi8((char)(0xE0 - 0x80)));
+    __m128i fourth = _mm_subs_epu8(_mm_alignr_epi8(in, prev, 13), _mm_set1_epi8((char)(0xF0 - 0x80)));
+    __m128i must23 = _mm_and_si128(_mm_or_si128(third, fourth), _mm_set1_epi8((char)0x80));
+
+    return _mm_xor_si128(must23, sc);
+}
+
+__attribute__((target("ssse3")))
+static size_t contract_utf8_ssse3(const unsigned char *s, size_t n) {
+    const __m128i limit = _mm_loadu_si128((const __m128i *)(utf8_incomplete + 16));
+    __m128i prev = _mm_setzero_si128(), incomplete = _mm_setzero_si128(), err, in;
+    size_t i = 0, j;
+
+    for (; i + CONTRACT_UTF8_BLOCK <= n; i += CONTRACT_UTF8_BLOCK) {
+        err = _mm_setzero_si128();
+        for (j = 0; j < CONTRACT_UTF8_BLOCK; j += 16) {
+            in = _mm_loadu_si128((const __m128i *)(s + i + j));
+            if (!_mm_movemask_epi8(in)) {
+                err = _mm_or_si128(err, incomplete);
+            } else {
+                err = _mm_or_si128(err, contract_utf8_check_ssse3(in, prev));
+                incomplete = _mm_subs_epu8(in, limit);
+            }
+            prev = in;
+        }
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(err, _mm_setzero_si128())) != 0xFFFF) return i;
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+static __m256i contract_utf8_check_avx2(__m256i in, __m256i prev) {
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    __m256i carried = _mm256_permute2x128_si256(prev, in, 0x21);    // prev's upper lane, in's lower lane
+    __m256i prev1 = _mm256_alignr_epi8(in, carried, 15);
+    __m256i sc = _mm256_and_si256(
+        _mm256_and_si256(
+            _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)utf8_byte1_high)),
+                                _mm256_and_si256(_mm256_srli_epi16(prev1, 4), nibble)),
+            _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)utf8_byte1_low)),
+                                _mm256_and_si256(prev1, nibble))),
+        _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)utf8_byte2_high)),
+                            _mm256_and_si256(_mm256_srli_epi16(in, 4), nibble)));
+    __m256i third = _mm256_subs_epu8(_mm256_alignr_epi8(in, carried, 14), _mm256_set1_epi8((char)(0xE0 - 0x80)));
+    __m256i fourth = _mm256_subs_epu8(_mm256_alignr_epi8(in, carried, 13), _mm256_set1_epi8((char)(0xF0 - 0x80)));
+    __m256i must23 = _mm256_and_si256(_mm256_or_si256(third, fourth), _mm256_set1_epi8((char)0x80));
+
+    return _mm256_xor_si256(must23, sc);
+}
+
+__attribute__((target("avx2")))
+static size_t contract_utf8_avx2(const unsigned char *s, size_t n) {
+    const __m256i limit = _mm256_loadu_si256((const __m256i *)utf8_incomplete);
+    __m256i prev = _mm256_setzero_si256(), incomplete = _mm256_setzero_si256(), err, in;
+    size_t i = 0, j;
+
+    for (; i + CONTRACT_UTF8_BLOCK <= n; i += CONTRACT_UTF8_BLOCK) {
+        err = _mm256_setzero_si256();
+        for (j = 0; j < CONTRACT_UTF8_BLOCK; j += 32) {
+            in = _mm256_loadu_si256((const __m256i *)(s + i + j));
+            if (!_mm256_movemask_epi8(in)) {
+                err = _mm256_or_si256(err, incomplete);
+            } else {
+                err = _mm256_or_si256(err, contract_utf8_check_avx2(in, prev));
+                incomplete = _mm256_subs_epu8(in, limit);
+            }
+            prev = in;
+        }
+        if (!_mm256_testz_si256(err, err)) return i;
+    }
+    return i;
+}
+#endif
+
+#if CONTRACT_UTF8_NEON
+static uint8x16_t contract_utf8_check_neon(uint8x16_t in, uint8x16_t prev) {
+    const uint8x16_t nibble = vdupq_n_u8(0x0F);
+    uint8x16_t prev1 = vextq_u8(prev, in, 15);
+    uint8x16_t sc = vandq_u8(
+        vandq_u8(vqtbl1q_u8(vld1q_u8(utf8_byte1_high), vshrq_n_u8(prev1, 4)),
+                 vqtbl1q_u8(vld1q_u8(utf8_byte1_low), vandq_u8(prev1, nibble))),
+        vqtbl1q_u8(vld1q_u8(utf8_byte2_high), vshrq_n_u8(in, 4)));
+    uint8x16_t third = vqsubq_u8(vextq_u8(prev, in, 14), vdupq_n_u8(0xE0 - 0x80));
+    uint8x16_t fourth = vqsubq_u8(vextq_u8(prev, in, 13), vdupq_n_u8(0xF0 - 0x80));
+    uint8x16_t must23 = vandq_u8(vorrq_u8(third, fourth), vdupq_n_u8(0x80));
+
+    return veorq_u8(must23, sc);
+}
+
+static size_t contract_utf8_neon(const unsigned char *s, size_t n) {
+    const uint8x16_t limit = vld1q_u8(utf8_incomplete + 16);
+    uint8x16_t prev = vdupq_n_u8(0), incomplete = vdupq_n_u8(0), err, in;
+    size_t i = 0, j;
+
+    for (; i + CONTRACT_UTF8_BLOCK <= n; i += CONTRACT_UTF8_BLOCK) {
+        err = vdupq_n_u8(0);
+        for (j = 0; j < CONTRACT_UTF8_BLOCK; j += 16) {
+            in = vld1q_u8(s + i + j);
+            if (vmaxvq_u8(in) < 0x80) {
+                err = vorrq_u8(err, incomplete);
+            } else {
+                err = vorrq_u8(err, contract_utf8_check_neon(in, prev));
+                incomplete = vqsubq_u8(in, limit);
+            }
+            prev = in;
+        }
+        if (vmaxvq_u8(err)) return i;
+    }
+    return i;
+}
+#endif
+
+// Offset the vector kernel got to, everything before its block is well-formed
+static size_t contract_utf8_simd(const unsigned char *s, size_t n) {
+#if CONTRACT_UTF8_X86
+    switch (contract_utf8_isa()) {
+    case 2: return contract_utf8_avx2(s, n);
+    case 1: return contract_utf8_ssse3(s, n);
+    default: return 0;
+    }
+#elif CONTRACT_UTF8_NEON
+    return contract_utf8_neon(s, n);
+#else
+    (void)s;
+    (void)n;
+    return 0;
+#endif
+}
+
+size_t contract_utf8_find_invalid(const void *buf, size_t len) {
+    return contract_utf8_scan((const unsigned char *)buf, 0, len);
+}
+
+int contract_utf8_valid(const void *buf, size_t len) {
+    const unsigned char *s = (const unsigned char *)buf;
+
+    return contract_utf8_scan(s, contract_utf8_resume(s, contract_utf8_simd(s, len)), len) == len;
+}
+
+int _contract_utf8_valid(const void *buf, size_t len) {
+    const unsigned char *s = (const unsigned char *)buf;
+    size_t bad = contract_utf8_scan(s, contract_utf8_resume(s, contract_utf8_simd(s, len)), len);
+
+    if (CONTRACT_LIKELY(bad == len)) return 1;
+    _contract_set_index((long)bad);
+    return 0;
+}
@@ -0,0 +1,49 @@
+/**
+ * @file contract_utf8.h
+ * @brief UTF-8 validation for the encoding contracts, SIMD lookup tables with a DFA fallback
+ * @version 0.1.4
+ * @license MIT
+ * @author Jeremy Thornton
+ */
+#ifndef CONTRACT_UTF8_H
+#define CONTRACT_UTF8_H
+
+#include "contract.h"
+
+/**
+ * @brief Tests that buf holds well-formed UTF-8, as defined by RFC 3629
+ *
+ * Overlong forms, surrogates (U+D800 to U+DFFF), code points above U+10FFFF and sequences truncated
+ * at the end of the buffer are rejected. NUL bytes are valid.
+ *
+ * The vector kernels classify each byte pair with three 16 entry lookups on the high and low
+ * nibbles (the method of Keiser and Lemire) and test 64 bytes per branch, AVX2 or SSSE3 selected
+ * at run time on x86, NEON on AArch64. All-ASCII blocks skip the lookups. Elsewhere, 8086 included,
+ * a table driven DFA runs behind a word-at-a-time ASCII skip.
+ *
+ * @param buf Bytes to validate, may be NULL when len is 0
+ * @param len Number of bytes
+ * @return 1 if valid, 0 otherwise
+ */
+int contract_utf8_valid(const void *buf, size_t len);
+
+/**
+ * @brief Start of the first ill-formed sequence, scalar, for reporting
+ *
+ * @return Offset of the first byte of the first ill-formed or truncated sequence, len if there is none
+ */
+size_t contract_utf8_find_invalid(const void *buf, size_t len);
+
+/**
+ * @brief Form of contract_utf8_valid() used by the contracts, a failure records the offset for the report
+ */
+int _contract_utf8_valid(const void *buf, size_t len);
+
+// UTF-8 contracts, the report ends in " (index N)" with the offset of the first ill-formed sequence
+#define require_utf8(buf, len, msg) _CONTRACT_REQUIRE_FILESYSTEM(_contract_utf8_valid(buf, len), msg, POSIX_EILSEQ)  /// @example require_utf8(body, body_len, "Request body is not UTF-8");
+#define ensure_utf8(buf, len, msg) _CONTRACT_ENSURE_MEMORY(_contract_utf8_valid(buf, len), msg, POSIX_EILSEQ)  /// @example ensure_utf8(out, out_len, "Transcoder produced invalid UTF-8");
+
+#define try_require_utf8(buf, len, msg) _CONTRACT_TRY_REQUIRE_FILESYSTEM(_contract_utf8_valid(buf, len), msg, POSIX_EILSEQ)
+#define try_ensure_utf8(buf, len, msg) _CONTRACT_TRY_ENSURE_MEMORY(_contract_utf8_valid(buf, len), msg, POSIX_EILSEQ)
+
+#endif
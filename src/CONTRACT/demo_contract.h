@@ -2,7 +2,6 @@
 #define DEMO_CONTRACTS_H
 
 #include "contract.h"
-#include "contract_tools.h"
 #include <stdio.h>
 #include <stdbool.h>
 
@@ -29,7 +28,7 @@
  *         No license restrictions; contribution is part of the public domain.
  *
  * @see contract.h
- * @see validate_error_strings()
+ * @see contract_strerror()
  */
 void demo_contracts(void) {
     printf("DESIGN-BY-CONTRACT MACROS DEMO\n");
@@ -44,7 +43,7 @@ void demo_contracts(void) {
     // Dummy values
     int zero = 0;
     int one = 1;
-    int ptr = 0;
+    void *ptr = NULL;
     int val = 150;
 
     printf("1. DEFAULT CONTRACTS require, ensure, invariant\n");
@@ -55,7 +54,7 @@ void demo_contracts(void) {
     PAUSE();
 
     printf("2. MEMORY & ADDRESS CONTRACTS\n");
-    require_address(ptr == 0, "Null pointer not allowed");
+    require_address(ptr == NULL, "Null pointer not allowed");
     require_mem(zero, "Memory allocation failed");
     ensure_address(ptr, "Function returned null pointer");
     require_aligned(zero, "Pointer not properly aligned");
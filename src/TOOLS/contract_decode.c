@@ -0,0 +1,39 @@
+#include "../CONTRACT/contract_decode.h"
+#include <stdio.h>
+
+/**
+ * @brief contract_decode <log> [site table]
+ *
+ * Prints a binary contract log in the standard text report format, see contract_decode_log(), or
+ * expands the site ids of a text log from a CONTRACT_STRIP_TEXT build and its CONTRACT_TIMESTAMP_RAW
+ * timestamps, see contract_decode_text().
+ * The site table is the output of contract_site_dump() from an unstripped build of the same sources.
+ */
+int main(int argc, char *argv[]) {
+    FILE *log;
+    FILE *table = NULL;
+
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <log> [site table]\n", argv[0]);
+        return 2;
+    }
+    log = fopen(argv[1], "rb");
+    if (!log) {
+        perror(argv[1]);
+        return 1;
+    }
+    if (argc > 2 && !(table = fopen(argv[2], "r"))) {
+        perror(argv[2]);
+        fclose(log);
+        return 1;
+    }
+
+    if (contract_decode_log(log, table, stdout) < 0) {    // no binary header, a text log
+        rewind(log);
+        contract_decode_text(log, table, stdout);
+    }
+
+    fclose(log);
+    if (table) fclose(table);
+    return 0;
+}
@@ -0,0 +1,13 @@
+# Open Watcom V2 toolchain for 16 bit DOS, see CMakePresets.json or cmk.sh
+#   cmake -G "Watcom WMake" -D CMAKE_TOOLCHAIN_FILE=cmake/watcom-dos.cmake -S. -B ../bin
+
+set(CMAKE_SYSTEM_NAME DOS)      # Target DOS
+set(CMAKE_SYSTEM_PROCESSOR I86)
+
+set(CMAKE_C_COMPILER wcl)
+set(CMAKE_CXX_COMPILER wcl)
+set(CMAKE_LINKER wlink)         # Use Watcom's linker
+
+# Warning: This skips critical compiler checks. Only use this if Watcom fails CMake's detection
+# Necessary to suppress compiler checks for cross compilation using OW2 and C under ARM environments
+set(CMAKE_C_COMPILER_WORKS 1)
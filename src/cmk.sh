@@ -4,4 +4,5 @@ echo "Running CMAKE for OW2..."
 # clean cache
 rm -rf ../bin/CMakeCache.txt ../bin/CMakeFiles/
 
-cmake -G "Watcom WMake" -D CMAKE_SYSTEM_NAME=DOS -D CMAKE_SYSTEM_PROCESSOR=I86 -S. -B ../bin
+# same as: cmake --preset dos
+cmake -G "Watcom WMake" -D CMAKE_TOOLCHAIN_FILE=cmake/watcom-dos.cmake -S. -B ../bin
@@ -1,6 +1,13 @@
 #include "CONTRACT/demo_contract.h"
+#include "CONTRACT/contract_binlog.h"
+#include <string.h>
 
-int main() {
+int main(int argc, char *argv[]) {
+    // DbC --sites > DbC.sit writes the site table contract_decode needs for stripped or binary logs
+    if (argc > 1 && strcmp(argv[1], "--sites") == 0) {
+        contract_site_dump(stdout);
+        return 0;
+    }
     demo_contracts();
     return 0;
 }